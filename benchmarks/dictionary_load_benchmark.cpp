@@ -0,0 +1,174 @@
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint> //uint8_t, uint32_t
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <radius_lite/dictionaries.h>
+#include <radius_lite/frozen_dictionaries.h>
+
+#include "utils.h"
+
+namespace
+{
+  long max_rss_kb()
+  {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  // root dictionary with standard attributes and values, one included file per vendor,
+  // returns the number of ATTRIBUTE and VALUE lines
+  size_t make_dictionary_tree(
+    const std::filesystem::path& directory,
+    size_t vendors,
+    size_t vendor_attributes,
+    size_t values)
+  {
+    size_t lines = 0;
+    std::ofstream root(directory / "dictionary");
+
+    for (size_t code = 1; code < 256; ++code)
+    {
+      root << "ATTRIBUTE Attribute-" << code << " " << code << " integer\n";
+      ++lines;
+
+      for (size_t value = 1; value <= values; ++value)
+      {
+        root << "VALUE Attribute-" << code << " Value-" << value << " " << value << "\n";
+        ++lines;
+      }
+    }
+
+    for (size_t vendor = 1; vendor <= vendors; ++vendor)
+    {
+      const std::string vendor_name = "Vendor-" + std::to_string(vendor);
+      const std::string file_name = "dictionary." + vendor_name;
+      root << "$INCLUDE " << file_name << "\n";
+
+      std::ofstream file(directory / file_name);
+      file << "VENDOR " << vendor_name << " " << vendor << "\n";
+      file << "BEGIN-VENDOR " << vendor_name << "\n";
+
+      for (size_t code = 1; code <= vendor_attributes; ++code)
+      {
+        const std::string attribute_name = vendor_name + "-Attribute-" + std::to_string(code);
+        file << "ATTRIBUTE " << attribute_name << " " << code << " string\n";
+        ++lines;
+
+        for (size_t value = 1; value <= values; ++value)
+        {
+          file << "VALUE " << attribute_name << " Value-" << value << " " << value << "\n";
+          ++lines;
+        }
+      }
+
+      file << "END-VENDOR " << vendor_name << "\n";
+    }
+
+    return lines;
+  }
+
+  double source_megabytes(const radius_lite::Dictionaries& dictionaries)
+  {
+    uintmax_t bytes = 0;
+
+    for (const auto& path : dictionaries.source_files())
+    {
+      bytes += std::filesystem::file_size(path);
+    }
+
+    return static_cast<double>(bytes) / (1024 * 1024);
+  }
+
+  // parse throughput of an existing dictionary tree, loaded repeatedly
+  void measure_dictionary(const std::string& path)
+  {
+    const double megabytes = source_megabytes(radius_lite::Dictionaries(path));
+    const size_t iterations = std::max<size_t>(10, static_cast<size_t>(20 / megabytes));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+      radius_lite::Dictionaries dictionaries(path);
+      dictionaries.resolve();
+    }
+
+    const auto finish = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(finish - start).count();
+
+    std::cout << std::left << std::setw(24) << path << std::right << std::fixed <<
+      std::setprecision(3) <<
+      std::setw(12) << seconds * 1000 / iterations << " ms" <<
+      std::setw(12) << std::setprecision(1) << megabytes * iterations / seconds << " MB/s" << std::endl;
+  }
+}
+
+// Startup cost of a large synthetic dictionary tree with $INCLUDE:
+// load time, allocations and resident memory of Dictionaries, of the frozen snapshot
+// and of opening its saved image. Dictionary paths given as arguments are measured as well.
+int main(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    measure_dictionary(argv[i]);
+  }
+
+  const auto directory = std::filesystem::temp_directory_path() / "radius_lite_dictionary_benchmark";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  const size_t lines = make_dictionary_tree(directory, 100, 250, 4);
+  std::cout << "dictionary tree: 101 files, " << lines << " ATTRIBUTE/VALUE lines" << std::endl;
+
+  const long start_rss = max_rss_kb();
+  size_t start_allocations = bench::allocations();
+  auto start = std::chrono::steady_clock::now();
+
+  radius_lite::Dictionaries dictionaries((directory / "dictionary").string());
+  dictionaries.resolve();
+
+  auto finish = std::chrono::steady_clock::now();
+  std::cout << std::left << std::setw(24) << "Dictionaries load" << std::right << std::fixed <<
+    std::setprecision(1) <<
+    std::setw(12) << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" <<
+    std::setw(12) << bench::allocations() - start_allocations << " allocs" <<
+    std::setw(12) << max_rss_kb() - start_rss << " KB max rss growth" <<
+    std::setw(12) << source_megabytes(dictionaries) /
+      std::chrono::duration<double>(finish - start).count() << " MB/s" << std::endl;
+
+  start_allocations = bench::allocations();
+  start = std::chrono::steady_clock::now();
+
+  const radius_lite::FrozenDictionaries frozen(dictionaries);
+
+  finish = std::chrono::steady_clock::now();
+  std::cout << std::left << std::setw(24) << "FrozenDictionaries build" << std::right << std::fixed <<
+    std::setprecision(1) <<
+    std::setw(12) << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" <<
+    std::setw(12) << bench::allocations() - start_allocations << " allocs" << std::endl;
+
+  const auto image_path = (directory / "dictionary.image").string();
+  frozen.save(image_path);
+
+  start_allocations = bench::allocations();
+  start = std::chrono::steady_clock::now();
+
+  const auto loaded = radius_lite::FrozenDictionaries::open((directory / "dictionary").string(), image_path);
+
+  finish = std::chrono::steady_clock::now();
+  std::cout << std::left << std::setw(24) << "FrozenDictionaries open" << std::right << std::fixed <<
+    std::setprecision(3) <<
+    std::setw(12) << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" <<
+    std::setw(12) << bench::allocations() - start_allocations << " allocs" << std::endl;
+
+  std::filesystem::remove_all(directory);
+
+  return frozen.vendor_code("Vendor-1") && loaded.vendor_code("Vendor-1") ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <cstdint> //uint8_t, uint32_t
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <radius_lite/attribute_types.h>
+#include <radius_lite/error.h>
+#include <radius_lite/packet.h>
+#include <radius_lite/packet_codes.h>
+
+#include "utils.h"
+
+namespace
+{
+  // truncated, wrong Length, broken attribute framing, short integer
+  // and Message-Authenticator of another secret
+  std::vector<std::vector<uint8_t>> make_malformed(const radius_lite::SecretContext& secret)
+  {
+    const std::vector<uint8_t> request = bench::make_request(secret.secret(), 20);
+    std::vector<std::vector<uint8_t>> result;
+
+    result.emplace_back(request.begin(), request.begin() + 19);
+    result.emplace_back(request.begin(), request.end() - 1);
+
+    result.push_back(request);
+    result.back()[21] = 0;
+
+    result.push_back({
+      0x04, 0x01, 0x00, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x05, 0x05, 0x00, 0x00, 0x01});
+
+    radius_lite::Packet signed_request(
+      radius_lite::ACCESS_REQUEST,
+      1,
+      {new radius_lite::String(radius_lite::USER_NAME, "test")},
+      {});
+    signed_request.addMessageAuthenticator();
+    result.push_back(signed_request.makeSendBuffer(radius_lite::SecretContext("other")));
+
+    return result;
+  }
+}
+
+// Decode of 100% malformed traffic (misconfigured NAS, scanner):
+// throwing constructor with catch per datagram against Packet::parse.
+int main()
+{
+  const radius_lite::SecretContext secret("secret");
+  const std::vector<std::vector<uint8_t>> malformed = make_malformed(secret);
+  const size_t iterations = 200000;
+  size_t next = 0;
+  size_t errors = 0;
+
+  bench::run("Packet constructor + catch", iterations, [&]
+  {
+    const auto& datagram = malformed[next++ % malformed.size()];
+
+    try
+    {
+      radius_lite::Packet packet(datagram.data(), datagram.size(), secret);
+      (void)packet;
+    }
+    catch (const radius_lite::Exception& exception)
+    {
+      errors += exception.getErrorCode() ? 1 : 0;
+    }
+  });
+
+  bench::run("Packet::parse", iterations, [&]
+  {
+    const auto& datagram = malformed[next++ % malformed.size()];
+
+    boost::system::error_code ec;
+    const auto packet = radius_lite::Packet::parse(datagram.data(), datagram.size(), secret, ec);
+    errors += ec ? 1 : 0;
+  });
+
+  return errors != 0 ? 0 : 1;
+}
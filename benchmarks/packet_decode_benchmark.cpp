@@ -0,0 +1,44 @@
+#include <cstdint> //uint8_t, uint32_t
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <radius_lite/packet.h>
+#include <radius_lite/packet_arena.h>
+#include <radius_lite/packet_view.h>
+
+#include "utils.h"
+
+// Decoding of Access-Request into Packet: heap allocated attributes against
+// attributes placed into the per-thread packet arena.
+int main()
+{
+  const radius_lite::SecretContext secret("secret");
+  const size_t iterations = 200000;
+
+  for (size_t attributes_count : {10, 30, 60})
+  {
+    const std::vector<uint8_t> request = bench::make_request(secret.secret(), attributes_count);
+    std::cout << "request: " << attributes_count << " attributes, " << request.size() << " bytes" << std::endl;
+
+    bench::run("PacketView", iterations, [&]
+    {
+      radius_lite::PacketView view(request.data(), request.size());
+      (void)view;
+    });
+
+    bench::run("Packet (heap)", iterations, [&]
+    {
+      radius_lite::Packet packet(request.data(), request.size(), secret);
+      (void)packet;
+    });
+
+    bench::run("Packet (arena)", iterations, [&]
+    {
+      radius_lite::Packet packet(request.data(), request.size(), secret, radius_lite::PacketArena::acquire());
+      (void)packet;
+    });
+  }
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <array>
+#include <cstdint> //uint8_t, uint32_t
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <openssl/md5.h>
+
+#include <radius_lite/attribute.h>
+#include <radius_lite/attribute_types.h>
+#include <radius_lite/packet.h>
+#include <radius_lite/packet_codes.h>
+#include <radius_lite/vendor_attribute.h>
+
+#include "utils.h"
+
+namespace
+{
+  // makeSendBuffer before in-place encoding: vector per attribute value and header,
+  // send buffer is extended with the secret for one-shot MD5 of the response authenticator
+  std::vector<uint8_t> legacy_send_buffer(const radius_lite::Packet& packet, const radius_lite::SecretContext& context)
+  {
+    const std::string& secret = context.secret();
+    std::vector<uint8_t> sendBuffer(20);
+
+    sendBuffer[0] = packet.type();
+    sendBuffer[1] = packet.id();
+
+    for (size_t i = 0; i < packet.auth().size(); ++i)
+    {
+      sendBuffer[i + 4] = packet.auth()[i];
+    }
+
+    for (const auto& attribute : packet.attributes())
+    {
+      const auto data = attribute->data(context, packet.auth());
+      std::vector<uint8_t> aData(2);
+      aData[0] = attribute->type();
+      aData[1] = static_cast<uint8_t>(2 + data.size());
+      aData.insert(aData.end(), data.begin(), data.end());
+      sendBuffer.insert(sendBuffer.end(), aData.begin(), aData.end());
+    }
+
+    for (const auto& vendorAttribute : packet.vendorSpecific())
+    {
+      const auto aData = vendorAttribute.toVector();
+      sendBuffer.insert(sendBuffer.end(), aData.begin(), aData.end());
+    }
+
+    sendBuffer[2] = static_cast<uint8_t>(sendBuffer.size() / 256 % 256);
+    sendBuffer[3] = static_cast<uint8_t>(sendBuffer.size() % 256);
+
+    sendBuffer.resize(sendBuffer.size() + secret.length());
+
+    for (size_t i = 0; i < secret.length(); ++i)
+    {
+      sendBuffer[i + sendBuffer.size() - secret.length()] = static_cast<uint8_t>(secret[i]);
+    }
+
+    std::array<uint8_t, 16> md;
+    MD5(sendBuffer.data(), sendBuffer.size(), md.data());
+
+    sendBuffer.resize(sendBuffer.size() - secret.length());
+
+    for (size_t i = 0; i < md.size(); ++i)
+      sendBuffer[i + 4] = md[i];
+
+    return sendBuffer;
+  }
+}
+
+// Encoding of Access-Accept with response authenticator: legacy vector concatenation
+// against makeSendBuffer and in-place encoding into a reused buffer,
+// with and without Message-Authenticator.
+int main()
+{
+  const radius_lite::SecretContext secret("a-rather-long-shared-secret-of-a-nas");
+  const size_t iterations = 200000;
+  const radius_lite::Auth auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  for (size_t attributes_count : {5, 20, 40})
+  {
+    const std::vector<uint8_t> request = bench::make_request(secret.secret(), attributes_count);
+    const radius_lite::Packet source(request.data(), request.size(), secret);
+
+    std::vector<radius_lite::Attribute*> attributes;
+    for (const auto& attribute : source.attributes())
+    {
+      attributes.push_back(attribute->clone());
+    }
+
+    const radius_lite::Packet response(
+      radius_lite::ACCESS_ACCEPT,
+      source.id(),
+      auth,
+      attributes,
+      source.vendorSpecific(),
+      true);
+
+    std::cout << "response: " << attributes_count << " attributes, " << response.encoded_size() << " bytes" << std::endl;
+
+    bench::run("legacy makeSendBuffer", iterations, [&]
+    {
+      auto buffer = legacy_send_buffer(response, secret);
+      (void)buffer;
+    });
+
+    bench::run("makeSendBuffer", iterations, [&]
+    {
+      auto buffer = response.makeSendBuffer(secret);
+      (void)buffer;
+    });
+
+    std::array<uint8_t, 4096> send_buffer;
+    bench::run("encode (reused buffer)", iterations, [&]
+    {
+      response.encode(send_buffer.data(), send_buffer.size(), secret);
+    });
+
+    radius_lite::Packet signed_response(response);
+    signed_response.addMessageAuthenticator();
+    bench::run("encode with Message-Authenticator", iterations, [&]
+    {
+      signed_response.encode(send_buffer.data(), send_buffer.size(), secret);
+    });
+  }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstdint> //uint8_t, uint32_t
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <radius_lite/packet.h>
+#include <radius_lite/packet_codes.h>
+#include <radius_lite/socket.h>
+
+#include "utils.h"
+
+namespace
+{
+  using boost::asio::ip::udp;
+
+  const uint16_t PORT = 3010;
+
+  // echo server on loopback: every request is answered with Access-Accept,
+  // the client keeps window requests in flight
+  void run(
+    radius_lite::Socket::Transport transport,
+    size_t batch_size,
+    size_t transactions,
+    size_t window)
+  {
+    const radius_lite::SecretContext secret("secret");
+    const std::vector<uint8_t> request = bench::make_request(secret.secret(), 20);
+
+    boost::asio::io_service io_service;
+    radius_lite::Socket* server = nullptr;
+    radius_lite::Socket socket(
+      io_service,
+      secret,
+      PORT,
+      [&server](
+        const boost::system::error_code& ec,
+        std::optional<radius_lite::Packet>&& packet,
+        const udp::endpoint& source)
+      {
+        if (ec || !packet)
+        {
+          return;
+        }
+
+        const radius_lite::Packet response(radius_lite::ACCESS_ACCEPT, packet->id(), packet->auth(), {}, {});
+        server->asyncSend(response, source, [](const boost::system::error_code&) {});
+      },
+      false,
+      transport);
+    server = &socket;
+    socket.set_batch_size(batch_size);
+
+    std::thread server_thread([&io_service] { io_service.run(); });
+
+    boost::asio::io_service client_service;
+    udp::socket client(client_service, udp::endpoint(udp::v4(), 0));
+    const udp::endpoint destination(boost::asio::ip::address_v4::loopback(), PORT);
+    std::vector<uint8_t> response(4096);
+
+    // datagrams dropped on socket buffer overflow would block the client forever
+    const timeval timeout{1, 0};
+    ::setsockopt(client.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    size_t sent = 0;
+    for (; sent < window && sent < transactions; ++sent)
+    {
+      client.send_to(boost::asio::buffer(request), destination);
+    }
+
+    size_t received = 0;
+    for (; received < transactions; ++received)
+    {
+      // asio blocking receive polls again on timeout, so the descriptor is read directly
+      if (::recv(client.native_handle(), response.data(), response.size(), 0) < 0)
+      {
+        break;
+      }
+
+      if (sent < transactions)
+      {
+        client.send_to(boost::asio::buffer(request), destination);
+        ++sent;
+      }
+    }
+
+    const auto finish = std::chrono::steady_clock::now();
+
+    io_service.stop();
+    server_thread.join();
+
+    const radius_lite::Socket::IoStats& stats = socket.io_stats();
+    const double seconds = std::chrono::duration<double>(finish - start).count();
+
+    const std::string name = socket.transport() == radius_lite::Socket::Transport::IO_URING ?
+      std::string("io_uring") :
+      "batch size " + std::to_string(batch_size);
+
+    std::cout << std::left << std::setw(40) << name <<
+      std::right << std::fixed << std::setprecision(0) <<
+      std::setw(12) << received / seconds << " packets/s" <<
+      std::setprecision(2) <<
+      std::setw(10) << static_cast<double>(stats.receive_calls + stats.send_calls) / stats.received <<
+      " calls/packet" <<
+      std::setw(8) << static_cast<double>(stats.receive_calls) / stats.received << " recv" <<
+      std::setw(8) << static_cast<double>(stats.send_calls) / stats.received << " send" <<
+      (received < transactions ? "  (" + std::to_string(transactions - received) + " lost)" : std::string()) <<
+      std::endl;
+  }
+}
+
+// Request/response throughput of one Socket on loopback:
+// receive and send call per datagram against recvmmsg/sendmmsg batches and io_uring.
+int main(int argc, char** argv)
+{
+  const size_t transactions = argc > 1 ? std::stoul(argv[1]) : 200000;
+  const size_t window = argc > 2 ? std::stoul(argv[2]) : 64;
+
+  for (const size_t batch_size : {1, 8, 32, 64})
+  {
+    run(radius_lite::Socket::Transport::ASIO, batch_size, transactions, window);
+  }
+
+  run(radius_lite::Socket::Transport::IO_URING, 1, transactions, window);
+
+  return 0;
+}
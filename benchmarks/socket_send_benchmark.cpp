@@ -0,0 +1,71 @@
+#include <cstdint> //uint8_t, uint32_t
+#include <iostream>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <radius_lite/attribute_types.h>
+#include <radius_lite/packet.h>
+#include <radius_lite/packet_codes.h>
+#include <radius_lite/socket.h>
+
+#include "utils.h"
+
+// Cost of one response on the io_service thread: Socket::asyncSend of Access-Accept
+// (encoded by asyncSend or prebuilt) to a loopback sink and the handlers it leaves for the io_service.
+int main()
+{
+  const radius_lite::SecretContext secret("secret");
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  const radius_lite::Packet response(
+    radius_lite::ACCESS_ACCEPT,
+    1,
+    auth,
+    {
+      new radius_lite::String(radius_lite::REPLY_MESSAGE, "Welcome"),
+      new radius_lite::Integer<uint32_t>(radius_lite::SESSION_TIMEOUT, 3600),
+      new radius_lite::Integer<uint32_t>(radius_lite::IDLE_TIMEOUT, 300)},
+    {});
+
+  boost::asio::io_service io_service;
+  radius_lite::Socket socket(
+    io_service,
+    secret,
+    3011,
+    [](const boost::system::error_code&, std::optional<radius_lite::Packet>&&, const boost::asio::ip::udp::endpoint&) {});
+
+  // responses are never read, the sink drops them once its buffer is full
+  boost::asio::ip::udp::socket sink(
+    io_service,
+    boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  const boost::asio::ip::udp::endpoint destination = sink.local_endpoint();
+
+  size_t errors = 0;
+  const std::function<void(const boost::system::error_code&)> callback =
+    [&errors](const boost::system::error_code& ec)
+    {
+      errors += ec ? 1 : 0;
+    };
+
+  io_service.poll();
+
+  bench::run("asyncSend on io_service thread", 200000, [&]
+  {
+    io_service.post([&] { socket.asyncSend(response, destination, callback); });
+    io_service.poll();
+  });
+
+  // prebuilt datagram (proxy forwarding, cached response), only the reference is passed
+  radius_lite::PacketBufferPtr datagram = radius_lite::PacketBuffer::acquire();
+  datagram->resize(response.encode(datagram->data(), radius_lite::PacketBuffer::CAPACITY, secret));
+
+  bench::run("asyncSend of pooled buffer on io_service thread", 200000, [&]
+  {
+    io_service.post([&] { socket.asyncSend(datagram, destination, callback); });
+    io_service.poll();
+  });
+
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include "utils.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <radius_lite/attribute_types.h>
+#include <radius_lite/packet_codes.h>
+
+namespace
+{
+  std::atomic<size_t> allocations_counter(0);
+}
+
+void* operator new(size_t size)
+{
+  allocations_counter.fetch_add(1, std::memory_order_relaxed);
+  void* result = std::malloc(size == 0 ? 1 : size);
+  if (!result)
+  {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept
+{
+  std::free(p);
+}
+
+namespace bench
+{
+  size_t allocations()
+  {
+    return allocations_counter.load(std::memory_order_relaxed);
+  }
+
+  std::vector<uint8_t> make_request(const std::string& /*secret*/, size_t attributes_count)
+  {
+    std::vector<uint8_t> result {
+      radius_lite::ACCESS_REQUEST, 1, 0, 0,
+      0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+    auto append = [&result](uint8_t type, const std::vector<uint8_t>& value)
+    {
+      result.push_back(type);
+      result.push_back(static_cast<uint8_t>(value.size() + 2));
+      result.insert(result.end(), value.begin(), value.end());
+    };
+
+    auto append_string = [&append](uint8_t type, const std::string& value)
+    {
+      append(type, std::vector<uint8_t>(value.begin(), value.end()));
+    };
+
+    append_string(radius_lite::USER_NAME, "subscriber@example.org");
+    // password ciphertext isn't checked by decoding, any full block is valid
+    append(radius_lite::USER_PASSWORD, {
+      0x8c, 0x06, 0xc8, 0x23, 0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87});
+    append(radius_lite::NAS_IP_ADDRESS, {10, 0, 0, 1});
+    append(radius_lite::NAS_PORT, {0, 0, 0x30, 0x39});
+    append_string(radius_lite::CALLING_STATION_ID, "79001234567");
+    append_string(radius_lite::CALLED_STATION_ID, "internet.apn");
+
+    // alternate standard and 3GPP (10415) attributes up to the requested count
+    for (size_t i = 6; i < attributes_count; ++i)
+    {
+      if (i % 2 == 0)
+      {
+        append(radius_lite::SESSION_TIMEOUT, {0, 0, 0x0e, static_cast<uint8_t>(i)});
+      }
+      else
+      {
+        append(radius_lite::VENDOR_SPECIFIC, {
+          0, 0, 0x28, 0xaf, static_cast<uint8_t>(i % 20 + 1), 8,
+          '2', '5', '0', '0', '1', static_cast<uint8_t>('0' + i % 10)});
+      }
+    }
+
+    result[2] = static_cast<uint8_t>(result.size() / 256);
+    result[3] = static_cast<uint8_t>(result.size() % 256);
+    return result;
+  }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint> //uint8_t, uint32_t
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+  // number of global operator new calls since process start
+  size_t allocations();
+
+  // Access-Request with User-Name, User-Password, NAS-IP-Address, NAS-Port,
+  // a few string/integer attributes and 3GPP vendor attributes,
+  // attributes_count is the approximate total count of attributes
+  std::vector<uint8_t> make_request(const std::string& secret, size_t attributes_count = 20);
+
+  template<typename Fun>
+  void run(const std::string& name, size_t iterations, Fun&& fun)
+  {
+    // warm up pools and caches
+    for (size_t i = 0; i < iterations / 10 + 1; ++i)
+    {
+      fun();
+    }
+
+    const size_t start_allocations = allocations();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+      fun();
+    }
+
+    const auto finish = std::chrono::steady_clock::now();
+    const size_t total_allocations = allocations() - start_allocations;
+    const double ns = std::chrono::duration<double, std::nano>(finish - start).count();
+
+    std::cout << std::left << std::setw(40) << name <<
+      std::right << std::fixed << std::setprecision(1) <<
+      std::setw(12) << ns / iterations << " ns/op" <<
+      std::setw(10) << static_cast<double>(total_allocations) / iterations << " allocs/op" <<
+      std::endl;
+  }
+}
@@ -5,10 +5,12 @@
 #include <array>
 #include <cstdint> //uint8_t, uint32_t
 #include <memory>
+#include <memory_resource>
 #include <optional>
 
 #include "error.h"
 #include "types.h"
+#include "secret_context.h"
 
 namespace radius_lite
 {
@@ -19,17 +21,27 @@ namespace radius_lite
     virtual ~Attribute() = default;
     uint8_t type() const { return m_type; }
     virtual std::string toString() const = 0;
-    virtual ByteArray data(const std::string& secret, const Auth& auth) const = 0;
+    virtual ByteArray data(const SecretContext& secret, const Auth& auth) const = 0;
 
     // rename to serialize
-    virtual std::vector<uint8_t> toVector(const std::string& secret, const Auth& auth) const;
+    virtual std::vector<uint8_t> toVector(const SecretContext& secret, const Auth& auth) const;
     virtual Attribute* clone() const = 0;
 
+    // size of the encoded attribute: type, length and value
+    virtual size_t encoded_size() const = 0;
+
+    // writes encoded_size() bytes into buffer without allocation, returns number of written bytes
+    virtual size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const = 0;
+
     virtual std::optional<int64_t> as_int() const;
     virtual std::optional<uint64_t> as_uint() const;
     virtual std::optional<std::string> as_string() const;
     virtual ByteArray as_octets() const = 0; // each type can be represented as octets
 
+    // value bytes without copy if the attribute keeps them in wire format,
+    // valid while the attribute is alive
+    virtual std::optional<ByteSpan> value_view() const;
+
   private:
     uint8_t m_type;
   };
@@ -38,18 +50,25 @@ namespace radius_lite
   class String: public Attribute
   {
   public:
-    String(uint8_t type, const uint8_t* data, size_t size);
+    String(
+      uint8_t type,
+      const uint8_t* data,
+      size_t size,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     String(uint8_t type, const std::string& string);
-    std::string toString() const override { return m_value; }
-    std::vector<uint8_t> data(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
-    //std::vector<uint8_t> toVector(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
+    std::string toString() const override { return std::string(m_value.data(), m_value.size()); }
+    std::vector<uint8_t> data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
+    //std::vector<uint8_t> toVector(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
     String* clone() const override;
+    size_t encoded_size() const override { return 2 + m_value.size(); }
+    size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const override;
 
     std::optional<std::string> as_string() const override;
     ByteArray as_octets() const override;
+    std::optional<ByteSpan> value_view() const override;
 
   private:
-    std::string m_value;
+    std::pmr::string m_value;
   };
 
   // Integer
@@ -60,9 +79,11 @@ namespace radius_lite
     Integer(uint8_t type, const uint8_t* data, size_t size);
     Integer(uint8_t type, uint32_t value);
     std::string toString() const override;
-    ByteArray data(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
-    //std::vector<uint8_t> toVector(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
+    ByteArray data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
+    //std::vector<uint8_t> toVector(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
     Integer* clone() const override;
+    size_t encoded_size() const override { return 2 + sizeof(IntType); }
+    size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const override;
 
     std::optional<int64_t> as_int() const override;
     std::optional<uint64_t> as_uint() const override;
@@ -80,12 +101,16 @@ namespace radius_lite
     IpAddress(uint8_t type, const uint8_t* data, size_t size);
     IpAddress(uint8_t type, const std::array<uint8_t, 4>& address);
     std::string toString() const override;
-    ByteArray data(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
+    ByteArray data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
     IpAddress* clone() const override;
+    size_t encoded_size() const override { return 2 + m_value.size(); }
+    size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const override;
 
     std::optional<std::string> as_string() const override;
+    // address as a host byte order number: 127.0.0.1 is 0x7f000001 (same as PacketReader::get_uint)
     std::optional<uint64_t> as_uint() const override;
     ByteArray as_octets() const override;
+    std::optional<ByteSpan> value_view() const override;
 
   private:
     std::array<uint8_t, 4> m_value;
@@ -95,56 +120,119 @@ namespace radius_lite
   class Encrypted : public Attribute
   {
   public:
-    Encrypted(uint8_t type, const uint8_t* data, size_t size, const std::string& secret, const std::array<uint8_t, 16>& auth);
+    Encrypted(
+      uint8_t type,
+      const uint8_t* data,
+      size_t size,
+      const SecretContext& secret,
+      const std::array<uint8_t, 16>& auth,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     Encrypted(uint8_t type, const std::string& password);
-    std::string toString() const override { return m_value; }
-    ByteArray data(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
-    //std::vector<uint8_t> toVector(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
+    std::string toString() const override;
+    ByteArray data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
+    //std::vector<uint8_t> toVector(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
     Encrypted* clone() const override;
+    size_t encoded_size() const override { return 2 + padded_size_(); }
+    size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const override;
 
     ByteArray as_octets() const override;
 
+    // decrypted value, decrypted on first call
+    std::optional<ByteSpan> value_view() const override;
+
+    // compares without allocation, doesn't cache the decrypted value
+    bool password_equals(const char* password, size_t size) const;
+
   private:
-    std::string m_value;
+    // received value is decrypted on first access, not thread safe
+    const std::pmr::string& value_() const;
+
+    // returns plaintext length (up to the first zero byte)
+    size_t decrypt_(std::array<uint8_t, 128>& plaintext) const;
+
+    // received value keeps the length of its ciphertext,
+    // new value is padded with zeros to 16 bytes boundary
+    size_t padded_size_() const;
+
+    // writes padded_size_() bytes of ciphertext
+    size_t encrypt_(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const;
+
+  private:
+    std::pmr::vector<uint8_t> m_ciphertext;
+    // secret state of the received value, ciphertext is decrypted with it
+    MD5_CTX m_secretMd5;
+    Auth m_auth;
+    mutable bool m_decrypted;
+    mutable std::pmr::string m_value;
   };
 
   class Bytes: public Attribute
   {
   public:
-    Bytes(uint8_t type, const uint8_t* data, size_t size);
+    Bytes(
+      uint8_t type,
+      const uint8_t* data,
+      size_t size,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     Bytes(uint8_t type, const std::vector<uint8_t>& bytes);
     std::string toString() const override;
-    ByteArray data(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
-    //std::vector<uint8_t> toVector(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
+    ByteArray data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
+    //std::vector<uint8_t> toVector(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
     Bytes* clone() const override;
+    size_t encoded_size() const override { return 2 + m_value.size(); }
+    size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const override;
 
     ByteArray as_octets() const override;
+    std::optional<ByteSpan> value_view() const override;
 
   private:
-    ByteArray m_value;
+    std::pmr::vector<uint8_t> m_value;
   };
 
   class ChapPassword: public Attribute
   {
   public:
-    ChapPassword(uint8_t type, const uint8_t* data, size_t size);
+    ChapPassword(
+      uint8_t type,
+      const uint8_t* data,
+      size_t size,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ChapPassword(uint8_t type, uint8_t chapId, const std::vector<uint8_t>& chapValue);
     std::string toString() const override;
     uint8_t chapId() const { return m_chapId; }
-    std::vector<uint8_t> chapValue() const { return m_value; }
-    ByteArray data(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
-    //std::vector<uint8_t> toVector(const std::string& secret, const std::array<uint8_t, 16>& auth) const override;
+    std::vector<uint8_t> chapValue() const { return std::vector<uint8_t>(m_value.begin(), m_value.end()); }
+    ByteArray data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
+    //std::vector<uint8_t> toVector(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const override;
     ChapPassword* clone() const override;
+    size_t encoded_size() const override { return 3 + m_value.size(); }
+    size_t encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const override;
 
     ByteArray as_octets() const override;
 
   private:
     uint8_t m_chapId;
-    ByteArray m_value;
+    std::pmr::vector<uint8_t> m_value;
   };
 
   using ConstAttributePtr = std::shared_ptr<const Attribute>;
   using AttributePtr = std::shared_ptr<Attribute>;
+
+  // owner of a packet attribute: attributes placed into a PacketArena are only destroyed,
+  // their memory is released with the arena, heap attributes are deleted
+  struct AttributeDeleter
+  {
+    bool in_arena = false;
+
+    void operator()(Attribute* attribute) const
+    {
+      if (in_arena)
+        attribute->~Attribute();
+      else
+        delete attribute;
+    }
+  };
+
+  using AttributeHolder = std::unique_ptr<Attribute, AttributeDeleter>;
 }
 
 namespace radius_lite
@@ -168,16 +256,17 @@ namespace radius_lite
     return std::nullopt;
   }
 
+  inline std::optional<ByteSpan>
+  Attribute::value_view() const
+  {
+    return std::nullopt;
+  }
+
   inline ByteArray
-  Attribute::toVector(const std::string& secret, const Auth& auth) const
-  {
-    auto serialize_data = data(secret, auth);
-    ByteArray result;
-    result.reserve(2 + serialize_data.size());
-    result.resize(2);
-    result[0] = type();
-    result[1] = 2 + serialize_data.size();
-    result.insert(result.end(), serialize_data.begin(), serialize_data.end());
+  Attribute::toVector(const SecretContext& secret, const Auth& auth) const
+  {
+    ByteArray result(encoded_size());
+    encode(result.data(), secret, auth);
     return result;
   }
 
@@ -218,16 +307,21 @@ namespace radius_lite
   }
 
   template<typename IntType>
-  std::vector<uint8_t> Integer<IntType>::data(const std::string& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
+  std::vector<uint8_t> Integer<IntType>::data(const SecretContext& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
   {
-    std::vector<uint8_t> attribute(2 + sizeof(IntType));
-    attribute[0] = type();
-    attribute[1] = 2 + sizeof(IntType);
+    return as_octets();
+  }
+
+  template<typename IntType>
+  size_t Integer<IntType>::encode(uint8_t* buffer, const SecretContext& /*secret*/, const Auth& /*auth*/) const
+  {
+    buffer[0] = type();
+    buffer[1] = 2 + sizeof(IntType);
     for (size_t i = 0; i < sizeof(IntType); ++i)
     {
-      attribute[2 + sizeof(IntType) - i - 1] = (m_value >> (i * 8)) & 0xFF;
+      buffer[2 + sizeof(IntType) - i - 1] = (m_value >> (i * 8)) & 0xFF;
     }
-    return attribute;
+    return 2 + sizeof(IntType);
   }
 
   template<typename IntType>
@@ -287,20 +381,41 @@ namespace radius_lite
     return ByteArray(m_value.begin(), m_value.end());
   }
 
+  inline std::optional<ByteSpan>
+  IpAddress::value_view() const
+  {
+    return ByteSpan(m_value.data(), m_value.size());
+  }
+
   // Encrypted inlines
+  inline std::string
+  Encrypted::toString() const
+  {
+    const auto& value = value_();
+    return std::string(value.data(), value.size());
+  }
+
   inline ByteArray
   Encrypted::as_octets() const
   {
+    const auto& value = value_();
     return ByteArray(
-      reinterpret_cast<const uint8_t*>(m_value.data()),
-      reinterpret_cast<const uint8_t*>(m_value.data()) + m_value.size());
+      reinterpret_cast<const uint8_t*>(value.data()),
+      reinterpret_cast<const uint8_t*>(value.data()) + value.size());
+  }
+
+  inline std::optional<ByteSpan>
+  Encrypted::value_view() const
+  {
+    const auto& value = value_();
+    return ByteSpan(reinterpret_cast<const uint8_t*>(value.data()), value.size());
   }
 
   // String inlines
   inline std::optional<std::string>
   String::as_string() const
   {
-    return m_value;
+    return std::string(m_value.data(), m_value.size());
   }
 
   inline ByteArray
@@ -311,17 +426,29 @@ namespace radius_lite
       reinterpret_cast<const uint8_t*>(m_value.data()) + m_value.size());
   }
 
+  inline std::optional<ByteSpan>
+  String::value_view() const
+  {
+    return ByteSpan(reinterpret_cast<const uint8_t*>(m_value.data()), m_value.size());
+  }
+
   // Bytes inlines
   inline ByteArray
   Bytes::as_octets() const
   {
-    return m_value;
+    return ByteArray(m_value.begin(), m_value.end());
   }
-  
+
+  inline std::optional<ByteSpan>
+  Bytes::value_view() const
+  {
+    return ByteSpan(m_value.data(), m_value.size());
+  }
+
   // ChapPassword inlines
   inline ByteArray
   ChapPassword::as_octets() const
   {
-    return m_value;
+    return ByteArray(m_value.begin(), m_value.end());
   }
 }
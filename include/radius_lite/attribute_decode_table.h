@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint> //uint8_t, uint32_t
+
+#include "dictionary_lookup.h"
+
+namespace radius_lite
+{
+  // Attribute class used by Packet for every standard attribute type,
+  // decode is a single table load and a switch over Kind.
+  class AttributeDecodeTable
+  {
+  public:
+    enum class Kind : uint8_t
+    {
+      BYTES,
+      STRING,
+      ENCRYPTED,
+      CHAP_PASSWORD,
+      IP_ADDRESS,
+      INTEGER8,
+      INTEGER16,
+      INTEGER32,
+      INTEGER64
+    };
+
+  public:
+    // RFC 2865, RFC 2866 types
+    constexpr AttributeDecodeTable();
+
+    // standard table with types of non vendor attributes taken from dictionaries,
+    // dictionaries should be resolved. User-Password and CHAP-Password keep their encodings,
+    // types unknown to Packet (ipv6addr, abinary, ...) keep the standard class.
+    explicit AttributeDecodeTable(const DictionaryLookup& dictionaries);
+
+    static const AttributeDecodeTable& standard();
+
+    Kind kind(uint8_t type) const { return kinds_[type]; }
+
+  private:
+    static constexpr std::array<Kind, 256> standard_kinds_();
+
+  private:
+    std::array<Kind, 256> kinds_;
+  };
+}
+
+namespace radius_lite
+{
+  constexpr std::array<AttributeDecodeTable::Kind, 256>
+  AttributeDecodeTable::standard_kinds_()
+  {
+    std::array<Kind, 256> kinds{};
+
+    for (auto& kind : kinds)
+    {
+      kind = Kind::BYTES;
+    }
+
+    for (uint8_t type : {1, 11, 18, 22, 34, 35, 60, 63})
+    {
+      kinds[type] = Kind::STRING;
+    }
+
+    kinds[2] = Kind::ENCRYPTED;
+    kinds[3] = Kind::CHAP_PASSWORD;
+
+    for (uint8_t type : {4, 8, 9, 14})
+    {
+      kinds[type] = Kind::IP_ADDRESS;
+    }
+
+    for (uint8_t type : {5, 6, 7, 10, 12, 13, 15, 16, 27, 28, 29, 37, 38, 61, 62})
+    {
+      kinds[type] = Kind::INTEGER32;
+    }
+
+    return kinds;
+  }
+
+  constexpr AttributeDecodeTable::AttributeDecodeTable()
+    : kinds_(standard_kinds_())
+  {}
+}
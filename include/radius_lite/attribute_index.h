@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint> //uint8_t, uint32_t
+#include <memory_resource>
+#include <vector>
+
+#include "attribute.h"
+#include "vendor_attribute.h"
+
+namespace radius_lite
+{
+  // Positions of packet attributes by type, built once when the packet is decoded.
+  // Standard attributes: 256-entry table of first occurrences plus a chain of next occurrences,
+  // vendor attributes: table sorted by (vendor id, vendor type, position).
+  class AttributeIndex
+  {
+  public:
+    static constexpr size_t npos = 0xFFFF;
+
+    struct VendorEntry
+    {
+      uint32_t vendor_id;
+      uint8_t vendor_type;
+      uint16_t position;
+    };
+
+    // vendor attribute occurrences in packet order
+    class VendorRange
+    {
+    public:
+      VendorRange(const VendorEntry* begin, const VendorEntry* end)
+        : begin_(begin), end_(end)
+      {}
+
+      const VendorEntry* begin() const { return begin_; }
+
+      const VendorEntry* end() const { return end_; }
+
+      bool empty() const { return begin_ == end_; }
+
+    private:
+      const VendorEntry* begin_;
+      const VendorEntry* end_;
+    };
+
+  public:
+    explicit AttributeIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    void build(const std::vector<AttributeHolder>& attributes, const std::vector<VendorSpecific>& vendorSpecific);
+
+    // position of first attribute with type in Packet::attributes() or npos
+    size_t first(uint8_t type) const { return first_[type]; }
+
+    // position of next attribute with the same type or npos
+    size_t next(size_t position) const { return next_[position]; }
+
+    // positions in Packet::vendorSpecific()
+    VendorRange vendor(uint32_t vendor_id, uint8_t vendor_type) const;
+
+  private:
+    std::array<uint16_t, 256> first_;
+    std::pmr::vector<uint16_t> next_;
+    std::pmr::vector<VendorEntry> vendor_;
+  };
+}
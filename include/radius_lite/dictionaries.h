@@ -1,15 +1,31 @@
 #pragma once
 
 #include <string>
+#include <functional>
 #include <map>
+#include <array>
 #include <cstdint> //uint8_t, uint32_t
 #include <optional>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
+#include <utility>
+
+#include "dictionary_lookup.h"
 
 namespace radius_lite
 {
+  struct DictionaryFile;
+
+  AttributeValueType attributeValueType(const std::string& typeName);
+
+  class FrozenDictionaries;
+
   class BasicDictionary
   {
+  public:
+    friend class FrozenDictionaries;
+
   public:
     BasicDictionary() = default;
 
@@ -17,17 +33,32 @@ namespace radius_lite
 
     uint32_t code(const std::string& name) const;
 
+    // non-throwing name and code, nullopt if absent; the view is valid while the dictionary isn't changed
+    std::optional<std::string_view> find_name(uint32_t code) const;
+
+    std::optional<uint32_t> find_code(std::string_view name) const;
+
     void add(uint32_t code, const std::string& name);
 
     void append(const BasicDictionary& basicDict);
 
+    void append(BasicDictionary&& basicDict);
+
+  private:
+    // code of name in right_dict_, names are unique there
+    std::optional<uint32_t> find_code_(const std::string& name) const;
+
   private:
     std::map<uint32_t, std::string> right_dict_;
-    std::map<std::string, uint32_t> reverse_dict_;
+    // transparent: string_view lookups don't build a std::string
+    std::map<std::string, uint32_t, std::less<>> reverse_dict_;
   };
 
   class DependentDictionary
   {
+  public:
+    friend class FrozenDictionaries;
+
   public:
     DependentDictionary() = default;
 
@@ -35,35 +66,46 @@ namespace radius_lite
 
     uint32_t code(const std::string& dependencyName, const std::string& name) const;
 
+    std::optional<std::string_view> find_name(const std::string& dependencyName, uint32_t code) const;
+
+    std::optional<uint32_t> find_code(std::string_view dependencyName, std::string_view name) const;
+
     void add(uint32_t code, const std::string& name, const std::string& dependencyName);
 
     void append(const DependentDictionary& dependentDict);
 
+    void append(DependentDictionary&& dependentDict);
+
   private:
-    std::map<std::pair<std::string, uint32_t>, std::string> right_dict_;
-    std::map<std::pair<std::string, std::string>, uint32_t> reverse_dict_;
-  };
+    // code of name of dependency in right_dict_, names of one dependency are unique there
+    std::optional<uint32_t> find_code_(const std::string& dependencyName, const std::string& name) const;
 
-  class Dictionaries
-  {
-  public:
-    struct AttributeKey
+    // orders (dependency, name) pairs of std::string and std::string_view alike
+    struct NamePairLess_
     {
-      uint8_t code = 0;
-      uint32_t vendor_id = 0;
+      using is_transparent = void;
 
-      AttributeKey() {}
-
-      AttributeKey(uint8_t code_val, uint32_t vendor_id_val = 0)
-        : code(code_val), vendor_id(vendor_id_val)
-      {}
-
-      bool operator==(const AttributeKey& right) const
+      template<typename Left, typename Right>
+      bool operator()(const Left& left, const Right& right) const
       {
-        return code == right.code && vendor_id == right.vendor_id;
+        return std::pair<std::string_view, std::string_view>(left.first, left.second) <
+          std::pair<std::string_view, std::string_view>(right.first, right.second);
       }
     };
 
+  private:
+    std::map<std::pair<std::string, uint32_t>, std::string> right_dict_;
+    std::map<std::pair<std::string, std::string>, uint32_t, NamePairLess_> reverse_dict_;
+  };
+
+  class Dictionaries: public DictionaryLookup
+  {
+  public:
+    friend class FrozenDictionaries;
+
+  public:
+    using AttributeKey = radius_lite::AttributeKey;
+
     struct AttributeKeyHash
     {
       std::size_t operator()(const AttributeKey& attribute_key) const;
@@ -74,6 +116,8 @@ namespace radius_lite
 
     void append(const Dictionaries& fillingDictionaries);
 
+    void append(Dictionaries&& fillingDictionaries);
+
     const BasicDictionary& attributes() const { return m_attributes; }
 
     const BasicDictionary& vendorNames() const { return m_vendorNames; }
@@ -106,12 +150,42 @@ namespace radius_lite
 
     uint32_t vendorAttributeValueCode(const std::string& valueName, const std::string& name) const;
 
+    // find_* lookups return nullopt instead of throwing std::out_of_range on a miss
+
+    std::optional<std::string_view> find_attribute_name(uint32_t code) const override;
+
+    std::optional<uint32_t> find_attribute_code(std::string_view name) const override;
+
+    std::optional<std::string_view> find_vendor_name(uint32_t code) const;
+
+    std::optional<uint32_t> find_vendor_code(const std::string& name) const;
+
+    std::optional<std::string_view> find_vendor_attribute_name(const std::string& vendorName, uint32_t code) const;
+
+    std::optional<uint32_t> find_vendor_attribute_code(const std::string& vendorName, const std::string& name) const;
+
+    std::optional<std::string_view> find_attribute_value_name(const std::string& attributeName, uint32_t code) const;
+
+    std::optional<uint32_t> find_attribute_value_code(const std::string& attributeName, const std::string& name) const;
+
+    std::optional<std::string_view> find_vendor_attribute_value_name(const std::string& valueName, uint32_t code) const;
+
+    std::optional<uint32_t> find_vendor_attribute_value_code(const std::string& valueName, const std::string& name) const;
+
     std::optional<std::string> get_attribute_type(uint8_t code, uint32_t vendor_id = 0) const;
 
+    std::optional<std::string_view> find_attribute_type(uint8_t code, uint32_t vendor_id = 0) const override;
+
+    // resolved when dictionary is loaded, NONE if attribute has no type, doesn't hash type names
+    AttributeValueType get_attribute_value_type(uint8_t code, uint32_t vendor_id = 0) const override;
+
     void resolve();
 
+    // loaded dictionary file followed by included and appended files
+    const std::vector<std::string>& source_files() const { return source_files_; }
+
     std::optional<AttributeKey>
-    get_attribute_key(const std::string& attribute_name, const std::string& vendor_name) const;
+    get_attribute_key(std::string_view attribute_name, std::string_view vendor_name) const override;
 
   private:
     struct UnresolvedAttributeKey
@@ -136,6 +210,14 @@ namespace radius_lite
       std::size_t operator()(const UnresolvedAttributeKey& attribute_key) const;
     };
 
+  private:
+    Dictionaries() = default;
+
+    void load_(const std::vector<DictionaryFile>& files, size_t index);
+
+    // first type of attribute wins as in the previous type map
+    void add_attribute_type_(const AttributeKey& attribute_key, const std::string& typeName);
+
   private:
     BasicDictionary m_attributes;
     BasicDictionary m_vendorNames;
@@ -145,6 +227,11 @@ namespace radius_lite
 
     std::unordered_map<AttributeKey, std::string, AttributeKeyHash> m_attributeTypes;
     std::unordered_map<UnresolvedAttributeKey, std::string, UnresolvedAttributeKeyHash> m_unresolvedAttributeTypes;
+
+    std::array<AttributeValueType, 256> value_types_{};
+    std::unordered_map<AttributeKey, AttributeValueType, AttributeKeyHash> vendor_value_types_;
+
+    std::vector<std::string> source_files_;
   };
 }
 
@@ -155,4 +242,16 @@ namespace radius_lite
   {
     return vendor_attribute_values_;
   }
+
+  inline AttributeValueType
+  Dictionaries::get_attribute_value_type(uint8_t code, uint32_t vendor_id) const
+  {
+    if (vendor_id == 0)
+    {
+      return value_types_[code];
+    }
+
+    auto it = vendor_value_types_.find(AttributeKey(code, vendor_id));
+    return it != vendor_value_types_.end() ? it->second : AttributeValueType::NONE;
+  }
 }
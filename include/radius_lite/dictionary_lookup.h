@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint> //uint8_t, uint32_t
+#include <optional>
+#include <string_view>
+
+namespace radius_lite
+{
+  // value types known to TypeDecoder, other dictionary types are decoded as octets
+  enum class AttributeValueType : uint8_t
+  {
+    NONE,
+    OCTETS,
+    STRING,
+    IPADDR,
+    BYTE,
+    UINT16,
+    INTEGER,
+    UINT32,
+    UINT64
+  };
+
+  // standard attribute if vendor_id is 0
+  struct AttributeKey
+  {
+    uint8_t code = 0;
+    uint32_t vendor_id = 0;
+
+    AttributeKey() {}
+
+    AttributeKey(uint8_t code_val, uint32_t vendor_id_val = 0)
+      : code(code_val), vendor_id(vendor_id_val)
+    {}
+
+    bool operator==(const AttributeKey& right) const
+    {
+      return code == right.code && vendor_id == right.vendor_id;
+    }
+  };
+
+  // Lookups used while packets are processed (PacketReader, ExtractionPlan, AttributeDecodeTable,
+  // DictionaryRegistry snapshots), implemented by parsed Dictionaries and by the FrozenDictionaries image.
+  // Lookups don't throw, views are valid while the dictionaries are alive.
+  class DictionaryLookup
+  {
+  public:
+    virtual ~DictionaryLookup() = default;
+
+    virtual std::optional<std::string_view> find_attribute_name(uint32_t code) const = 0;
+
+    virtual std::optional<uint32_t> find_attribute_code(std::string_view name) const = 0;
+
+    // type name as written in the dictionary
+    virtual std::optional<std::string_view> find_attribute_type(uint8_t code, uint32_t vendor_id = 0) const = 0;
+
+    // NONE if attribute has no type
+    virtual AttributeValueType get_attribute_value_type(uint8_t code, uint32_t vendor_id = 0) const = 0;
+
+    // nullopt if the vendor or its attribute is unknown
+    virtual std::optional<AttributeKey>
+    get_attribute_key(std::string_view attribute_name, std::string_view vendor_name) const = 0;
+  };
+}
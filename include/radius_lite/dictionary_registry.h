@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint> //uint64_t
+#include <memory>
+#include <string>
+
+#include "dictionary_lookup.h"
+
+namespace radius_lite
+{
+  // Publishes immutable dictionaries snapshots that can be replaced while packets are processed.
+  // reload parses and resolves dictionaries on the calling thread (not the IO thread) and swaps
+  // the snapshot atomically, users of the previous snapshot keep it alive through shared_ptr.
+  // Snapshots are parsed Dictionaries or FrozenDictionaries images if an image path is given.
+  class DictionaryRegistry
+  {
+  public:
+    // Cached view of the registry for one thread: dictionaries() is an atomic load of
+    // the registry version and a compare, the snapshot is reacquired only after publish.
+    class Reader
+    {
+    public:
+      explicit Reader(const DictionaryRegistry& registry);
+
+      // takes the latest snapshot, true if it differs from the previous one
+      bool update();
+
+      const DictionaryLookup& dictionaries()
+      {
+        update();
+        return *snapshot_;
+      }
+
+      const std::shared_ptr<const DictionaryLookup>& snapshot() const { return snapshot_; }
+
+    private:
+      const DictionaryRegistry& registry_;
+      uint64_t version_;
+      std::shared_ptr<const DictionaryLookup> snapshot_;
+    };
+
+  public:
+    // loads and resolves file_path, throws like Dictionaries; with image_path the snapshot is
+    // FrozenDictionaries::open(file_path, image_path), image is rebuilt if it is stale or invalid
+    explicit DictionaryRegistry(std::string file_path, std::string image_path = std::string());
+
+    explicit DictionaryRegistry(std::shared_ptr<const DictionaryLookup> dictionaries);
+
+    std::shared_ptr<const DictionaryLookup> snapshot() const;
+
+    // incremented by every publish
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    void publish(std::shared_ptr<const DictionaryLookup> dictionaries);
+
+    // reparses file_path (or reopens image) given to the constructor, current snapshot is kept if it throws
+    void reload();
+
+  private:
+    const std::string file_path_;
+    const std::string image_path_;
+    std::shared_ptr<const DictionaryLookup> current_;
+    std::atomic<uint64_t> version_;
+  };
+}
@@ -23,7 +23,9 @@ namespace radius_lite
     invalidAttributeSize,
     invalidVendorSpecificAttributeId,
     suchAttributeNameAlreadyExists,
-    suchAttributeCodeAlreadyExists
+    suchAttributeCodeAlreadyExists,
+    sendBufferIsTooSmall,
+    invalidMessageAuthenticator
   };
 
   class Exception: public std::runtime_error
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint> //uint8_t, uint32_t
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dictionary_lookup.h"
+#include "packet.h"
+#include "types.h"
+
+namespace radius_lite
+{
+  // Attributes wanted by a handler, names are resolved against dictionaries once,
+  // values are extracted from a packet in a single pass over its attributes.
+  class ExtractionPlan
+  {
+  public:
+    struct Field
+    {
+      std::string name;
+      // empty for standard attributes
+      std::string vendor_name;
+    };
+
+    // first occurrence of a field, octets point into the packet and are valid while it is alive
+    struct Value
+    {
+      bool present = false;
+      // dictionary type of the field, OCTETS if the value doesn't fit it,
+      // NONE if the packet keeps the value decoded and it doesn't fit the field type
+      // (integer attribute of a non-integer field, integer is still set)
+      AttributeValueType type = AttributeValueType::NONE;
+      // BYTE, UINT16, INTEGER, UINT32, UINT64
+      uint64_t integer = 0;
+      // other types, ipaddr in network byte order, User-Password decrypted
+      ByteSpan octets;
+    };
+
+  public:
+    // fields unknown to dictionaries are never present, dictionaries should be resolved
+    ExtractionPlan(const DictionaryLookup& dictionaries, const std::vector<Field>& fields);
+
+    size_t size() const { return types_.size(); }
+
+    // values should have size() elements, values[i] is filled for fields[i]
+    void extract(const Packet& packet, Value* values) const;
+
+  private:
+    struct VendorSlot
+    {
+      uint32_t vendor_id;
+      uint8_t vendor_type;
+      uint16_t slot;
+    };
+
+    static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+  private:
+    void add_vendor_slot_(uint32_t vendor_id, uint8_t vendor_type, uint16_t slot);
+
+    uint16_t vendor_slot_(uint32_t vendor_id, uint8_t vendor_type) const;
+
+    void fill_(Value& value, AttributeValueType type, const ByteSpan& octets) const;
+
+  private:
+    std::vector<AttributeValueType> types_;
+    std::array<uint16_t, 256> slots_;
+    // sorted by vendor id and vendor type
+    std::vector<VendorSlot> vendor_slots_;
+    // repeated fields are copied from the first slot of the same attribute
+    std::vector<std::pair<uint16_t, uint16_t>> duplicates_;
+  };
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <cstdint> //uint8_t, uint32_t
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "dictionaries.h"
+
+namespace radius_lite
+{
+  // Read-only copy of loaded Dictionaries for lookups after startup:
+  // names are kept in one string pool, code -> name and name -> code tables are sorted arrays
+  // searched without allocation. Missing names are returned as empty views, missing codes as nullopt.
+  //
+  // All data is kept in one position independent image that can be saved to a file
+  // and mapped back by later processes without parsing the text dictionaries,
+  // the image is used as DictionaryLookup directly.
+  class FrozenDictionaries: public DictionaryLookup
+  {
+  public:
+    // dictionaries should be resolved, their source files are recorded for is_up_to_date
+    explicit FrozenDictionaries(const Dictionaries& dictionaries);
+
+    // maps image saved by save, throws std::runtime_error if it isn't a valid image of this version:
+    // string references, enums and the order of lookup tables are checked before it is used
+    static FrozenDictionaries load(const std::string& image_path);
+
+    // image if it is up to date for dictionary_path, otherwise text dictionaries are loaded
+    // and the image is rewritten (failure to write it is ignored)
+    static FrozenDictionaries open(const std::string& dictionary_path, const std::string& image_path);
+
+    // writes image through a temporary file renamed over image_path, throws std::runtime_error
+    void save(const std::string& image_path) const;
+
+    // true if every source dictionary file still has the recorded size and modification time
+    bool is_up_to_date() const;
+
+    // root dictionary file followed by included files
+    std::vector<std::string_view> source_files() const;
+
+    std::string_view attribute_name(uint32_t code) const;
+
+    std::optional<uint32_t> attribute_code(std::string_view name) const;
+
+    std::string_view vendor_name(uint32_t code) const;
+
+    std::optional<uint32_t> vendor_code(std::string_view name) const;
+
+    std::string_view vendor_attribute_name(std::string_view vendor_name, uint32_t code) const;
+
+    std::optional<uint32_t> vendor_attribute_code(std::string_view vendor_name, std::string_view name) const;
+
+    std::string_view attribute_value_name(std::string_view attribute_name, uint32_t code) const;
+
+    std::optional<uint32_t> attribute_value_code(std::string_view attribute_name, std::string_view name) const;
+
+    std::string_view vendor_attribute_value_name(std::string_view value_name, uint32_t code) const;
+
+    std::optional<uint32_t> vendor_attribute_value_code(std::string_view value_name, std::string_view name) const;
+
+    std::string_view attribute_type_name(uint8_t code, uint32_t vendor_id = 0) const;
+
+    // DictionaryLookup
+
+    std::optional<std::string_view> find_attribute_name(uint32_t code) const override;
+
+    std::optional<uint32_t> find_attribute_code(std::string_view name) const override;
+
+    std::optional<std::string_view> find_attribute_type(uint8_t code, uint32_t vendor_id = 0) const override;
+
+    AttributeValueType get_attribute_value_type(uint8_t code, uint32_t vendor_id = 0) const override;
+
+    std::optional<AttributeKey>
+    get_attribute_key(std::string_view attribute_name, std::string_view vendor_name) const override;
+
+  private:
+    struct StringRef
+    {
+      uint32_t offset = 0;
+      uint32_t size = 0;
+    };
+
+    struct NameEntry
+    {
+      StringRef dependency;
+      uint32_t code;
+      StringRef name;
+    };
+
+    struct CodeEntry
+    {
+      StringRef dependency;
+      StringRef name;
+      uint32_t code;
+    };
+
+    struct TypeEntry
+    {
+      uint32_t vendor_id;
+      uint8_t code;
+      AttributeValueType type;
+      uint16_t reserved;
+      StringRef type_name;
+    };
+
+    struct SourceEntry
+    {
+      StringRef path;
+      uint32_t reserved;
+      uint64_t size;
+      int64_t modification_time;
+    };
+
+    enum Section
+    {
+      POOL,
+      ATTRIBUTE_NAMES,
+      ATTRIBUTE_CODES,
+      VENDOR_NAMES,
+      VENDOR_CODES,
+      ATTRIBUTE_VALUE_NAMES,
+      ATTRIBUTE_VALUE_CODES,
+      VENDOR_ATTRIBUTE_NAMES,
+      VENDOR_ATTRIBUTE_CODES,
+      VENDOR_ATTRIBUTE_VALUE_NAMES,
+      VENDOR_ATTRIBUTE_VALUE_CODES,
+      TYPES,
+      SOURCES,
+      SECTIONS_COUNT
+    };
+
+    struct SectionRef
+    {
+      uint32_t offset;
+      uint32_t count;
+    };
+
+    struct Header
+    {
+      std::array<char, 8> magic;
+      uint32_t version;
+      uint32_t byte_order;
+      uint64_t size;
+      std::array<SectionRef, SECTIONS_COUNT> sections;
+    };
+
+    // names sorted by (dependency, code), codes sorted by (dependency, name),
+    // dependency is empty for basic dictionaries
+    template<typename Entry>
+    struct Span
+    {
+      const Entry* begin;
+      const Entry* end;
+    };
+
+    class Builder;
+
+  private:
+    FrozenDictionaries(std::shared_ptr<const uint8_t> image, size_t size);
+
+    template<typename Entry>
+    Span<Entry> section_(Section section) const;
+
+    // every string reference is inside the pool, enums are known and tables are sorted
+    bool check_() const;
+
+    bool check_ref_(const StringRef& ref) const;
+
+    bool check_names_(Section section) const;
+
+    bool check_codes_(Section section) const;
+
+    std::string_view view_(const StringRef& ref) const;
+
+    std::string_view name_(Section section, std::string_view dependency, uint32_t code) const;
+
+    std::optional<uint32_t> code_(Section section, std::string_view dependency, std::string_view name) const;
+
+    const TypeEntry* type_(uint8_t code, uint32_t vendor_id) const;
+
+  private:
+    // heap buffer or read-only file mapping
+    std::shared_ptr<const uint8_t> image_;
+    size_t size_;
+    const Header* header_;
+  };
+}
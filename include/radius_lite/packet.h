@@ -3,8 +3,13 @@
 #include "attribute.h"
 #include "vendor_attribute.h"
 #include "dictionaries.h"
+#include "packet_view.h"
+#include "packet_arena.h"
+#include "attribute_index.h"
+#include "attribute_decode_table.h"
 
 #include <array>
+#include <optional>
 #include <vector>
 #include <string>
 #include <cstdint> //uint8_t, uint32_t
@@ -17,12 +22,42 @@ namespace radius_lite
     friend class PacketReader;
 
   public:
+    // if arena is passed, decoded attributes and their values are placed into it
+    // and the arena is returned to the pool when the packet is destroyed,
+    // decode table selects attribute classes by type, it isn't referenced after construction
     Packet(
       const uint8_t* buffer,
       size_t size,
-      const std::string& secret);
+      const SecretContext& secret,
+      PacketArenaPtr arena = PacketArenaPtr(),
+      const AttributeDecodeTable& decodeTable = AttributeDecodeTable::standard());
 
-    // request packet
+    // decodes attributes of an already validated datagram,
+    // Message-Authenticator of requests is checked, throws if it doesn't match
+    Packet(
+      const PacketView& view,
+      const SecretContext& secret,
+      PacketArenaPtr arena = PacketArenaPtr(),
+      const AttributeDecodeTable& decodeTable = AttributeDecodeTable::standard());
+
+    // non-throwing decode: nullopt and ec set to radius_lite::Error for every case
+    // where the constructors above throw
+    static std::optional<Packet> parse(
+      const uint8_t* buffer,
+      size_t size,
+      const SecretContext& secret,
+      boost::system::error_code& ec,
+      PacketArenaPtr arena = PacketArenaPtr(),
+      const AttributeDecodeTable& decodeTable = AttributeDecodeTable::standard());
+
+    static std::optional<Packet> parse(
+      const PacketView& view,
+      const SecretContext& secret,
+      boost::system::error_code& ec,
+      PacketArenaPtr arena = PacketArenaPtr(),
+      const AttributeDecodeTable& decodeTable = AttributeDecodeTable::standard());
+
+    // request packet, takes ownership of heap allocated attributes
     Packet(
       uint8_t type,
       uint8_t id,
@@ -40,21 +75,66 @@ namespace radius_lite
       bool recalc_auth = false
       );
 
+    // deep copy, clones every attribute
     Packet(const Packet& other);
-    ~Packet();
+
+    // takes attributes and arena of other, other is left empty
+    Packet(Packet&& other) noexcept = default;
+
+    Packet& operator=(const Packet&) = delete;
+    Packet& operator=(Packet&&) = delete;
+
     uint8_t type() const { return m_type; }
     uint8_t id() const { return m_id; };
     const std::array<uint8_t, 16>& auth() const { return m_auth; }
-    const std::vector<Attribute*>& attributes() const { return m_attributes; }
+    const std::vector<AttributeHolder>& attributes() const { return m_attributes; }
     const std::vector<VendorSpecific>& vendorSpecific() const { return m_vendorSpecific; }
-    const std::vector<uint8_t> makeSendBuffer(const std::string& secret) const;
+    const AttributeIndex& index() const { return m_index; }
+
+    // first occurrence or nullptr, constant time
+    const Attribute* find_attribute(uint8_t type) const;
+    const VendorSpecific* find_vendor_attribute(uint32_t vendor_id, uint8_t vendor_type) const;
+
+    // adds zero Message-Authenticator if there is none, its HMAC is calculated by encode
+    void addMessageAuthenticator();
+
+    const std::vector<uint8_t> makeSendBuffer(const SecretContext& secret) const;
+
+    // size of the encoded packet: header and all attributes
+    size_t encoded_size() const;
+
+    // encodes packet into caller buffer without allocation, returns packet length,
+    // throws if buffer is smaller than encoded_size()
+    size_t encode(uint8_t* buffer, size_t size, const SecretContext& secret) const;
+
+  private:
+    struct Checked {};
+
+    // Message-Authenticator and attribute sizes are already checked by check_
+    Packet(
+      const PacketView& view,
+      const SecretContext& secret,
+      PacketArenaPtr arena,
+      const AttributeDecodeTable& decodeTable,
+      Checked);
+
+    static Error check_(
+      const PacketView& view,
+      const SecretContext& secret,
+      const AttributeDecodeTable& decodeTable);
+
+    static std::vector<AttributeHolder> adopt_(const std::vector<Attribute*>& attributes);
 
   private:
+    // declared first: attributes and vendor attributes can use arena memory,
+    // they are destroyed before the arena is returned to the pool
+    PacketArenaPtr m_arena;
     uint8_t m_type;
     uint8_t m_id;
     bool m_recalcAuth;
     std::array<uint8_t, 16> m_auth;
-    std::vector<Attribute*> m_attributes;
+    std::vector<AttributeHolder> m_attributes;
     std::vector<VendorSpecific> m_vendorSpecific;
+    AttributeIndex m_index;
   };
 }
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint> //uint8_t, uint32_t
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace radius_lite
+{
+  template<typename T>
+  class OwnerPool;
+
+  // Monotonic memory for the decoded attributes of one packet.
+  // Allocation bumps a pointer inside preallocated chunks, deallocation is a no-op,
+  // all memory is released at once by reset() and chunks are kept for the next packet.
+  class PacketArena: public std::pmr::memory_resource
+  {
+  public:
+    // returns arena into the pool of the thread that acquired it, can be called on any thread
+    struct Releaser
+    {
+      void operator()(PacketArena* arena) const;
+    };
+
+    using Ptr = std::unique_ptr<PacketArena, Releaser>;
+
+  public:
+    explicit PacketArena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    PacketArena(const PacketArena&) = delete;
+
+    PacketArena& operator=(const PacketArena&) = delete;
+
+    // takes arena from the per-thread pool, creates new one if the pool is empty
+    static Ptr acquire();
+
+    void reset();
+
+    // number of chunks requested from the heap over arena lifetime
+    size_t chunks_count() const { return chunks_.size(); }
+
+  protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+  private:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 8192;
+
+    struct Chunk
+    {
+      std::unique_ptr<uint8_t[]> data;
+      size_t size;
+    };
+
+  private:
+    friend class OwnerPool<PacketArena>;
+
+  private:
+    const size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    size_t current_chunk_;
+    size_t offset_;
+    OwnerPool<PacketArena>* owner_pool_;
+    PacketArena* owner_pool_next_;
+  };
+
+  using PacketArenaPtr = PacketArena::Ptr;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint> //uint8_t, uint32_t
+
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+
+#include "types.h"
+
+namespace radius_lite
+{
+  class PacketBuffer;
+
+  template<typename T>
+  class OwnerPool;
+
+  using PacketBufferPtr = boost::intrusive_ptr<PacketBuffer>;
+
+  // Fixed size datagram buffer (RADIUS packets are limited by 4096 bytes) shared by reference count.
+  // Buffers are taken from the pool of the acquiring thread and return into that pool
+  // from any thread that drops the last reference (see OwnerPool), pools aren't locked.
+  class PacketBuffer
+  {
+  public:
+    static constexpr size_t CAPACITY = 4096;
+
+  public:
+    PacketBuffer(const PacketBuffer&) = delete;
+
+    PacketBuffer& operator=(const PacketBuffer&) = delete;
+
+    // empty buffer from the per-thread pool, new one if the pool is empty
+    static PacketBufferPtr acquire();
+
+    uint8_t* data() { return data_; }
+
+    const uint8_t* data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    // size should not exceed CAPACITY
+    void resize(size_t size) { size_ = size; }
+
+    ByteSpan span() const { return ByteSpan(data_, size_); }
+
+    // number of references, 1 if the buffer isn't shared
+    size_t use_count() const { return references_.load(std::memory_order_acquire); }
+
+    friend void intrusive_ptr_add_ref(PacketBuffer* buffer)
+    {
+      buffer->references_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    friend void intrusive_ptr_release(PacketBuffer* buffer)
+    {
+      if (buffer->references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        release_(buffer);
+      }
+    }
+
+  private:
+    friend class OwnerPool<PacketBuffer>;
+
+    PacketBuffer()
+      : references_(0),
+        size_(0),
+        owner_pool_(nullptr),
+        owner_pool_next_(nullptr)
+    {}
+
+    static void release_(PacketBuffer* buffer);
+
+  private:
+    std::atomic<size_t> references_;
+    size_t size_;
+    OwnerPool<PacketBuffer>* owner_pool_;
+    PacketBuffer* owner_pool_next_;
+    uint8_t data_[CAPACITY];
+  };
+}
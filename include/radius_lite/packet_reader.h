@@ -1,31 +1,83 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
 #include "attribute.h"
-#include "dictionaries.h"
+#include "dictionary_lookup.h"
 #include "packet.h"
 
 namespace radius_lite
 {
+  // packet is referenced and should outlive the reader
   class PacketReader
   {
   public:
     PacketReader(
       const Packet& packet,
-      const Dictionaries& dictionaries,
-      std::string secret);
+      const DictionaryLookup& dictionaries,
+      SecretContext secret);
+
+    // keeps the dictionaries snapshot (see DictionaryRegistry) alive while the reader exists
+    PacketReader(
+      const Packet& packet,
+      std::shared_ptr<const DictionaryLookup> dictionaries,
+      SecretContext secret);
 
+    // lookups go through the packet attribute index and don't scan the packet,
+    // values with a size that doesn't fit the dictionary type are skipped (null)
     ConstAttributePtr
-    get_attribute(const Dictionaries::AttributeKey& attribute_key) const;
+    get_attribute(const AttributeKey& attribute_key) const;
 
+    // all occurrences in packet order
+    std::vector<ConstAttributePtr>
+    get_attributes(const AttributeKey& attribute_key) const;
+
+    // null if the name is unknown to dictionaries, name lookups don't throw
     ConstAttributePtr
     get_attribute_by_name(const std::string& name) const;
 
     ConstAttributePtr
     get_attribute_by_name(const std::string& name, const std::string& vendor_name) const;
 
+    // compares User-Password with candidate, false if packet has no User-Password
+    bool
+    check_password(std::string_view password) const;
+
+    // typed accessors read the value of the first occurrence without allocation
+    // and don't depend on dictionary types, nullopt if there is no attribute
+    // or its value doesn't fit the requested type; views are valid while the packet is alive
+
+    // big-endian integer of 1, 2, 4 or 8 bytes converted to host byte order,
+    // IPv4 addresses give the same number as IpAddress::as_uint (127.0.0.1 is 0x7f000001)
+    std::optional<uint64_t>
+    get_uint(const AttributeKey& attribute_key) const;
+
+    // address in network byte order
+    std::optional<std::array<uint8_t, 4>>
+    get_ipv4(const AttributeKey& attribute_key) const;
+
+    // User-Password is returned decrypted
+    std::optional<std::string_view>
+    get_string_view(const AttributeKey& attribute_key) const;
+
+    std::optional<ByteSpan>
+    get_octets_view(const AttributeKey& attribute_key) const;
+
+  private:
+    ConstAttributePtr
+    decode_(const Attribute& attribute) const;
+
+    ConstAttributePtr
+    decode_(const VendorSpecific& attribute) const;
+
   private:
     const Packet& packet_;
-    const Dictionaries& dictionaries_;
-    const std::string secret_;
+    const std::shared_ptr<const DictionaryLookup> snapshot_;
+    const DictionaryLookup& dictionaries_;
+    const SecretContext secret_;
   };
 }
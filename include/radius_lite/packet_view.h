@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint> //uint8_t, uint32_t
+#include <iterator>
+#include <optional>
+
+#include "types.h"
+#include "error.h"
+#include "secret_context.h"
+
+namespace radius_lite
+{
+  // Non-owning view over a received datagram.
+  // Header and attribute framing are checked once in the constructor,
+  // attribute values are exposed as spans that point into the source buffer,
+  // so the buffer must outlive the view.
+  class PacketView
+  {
+  public:
+    struct AttributeView
+    {
+      uint8_t type = 0;
+      ByteSpan value;
+    };
+
+    struct VendorAttributeView
+    {
+      uint32_t vendor_id = 0;
+      uint8_t vendor_type = 0;
+      ByteSpan value;
+    };
+
+    class AttributeIterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = AttributeView;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const AttributeView*;
+      using reference = const AttributeView&;
+
+      AttributeIterator()
+        : pos_(nullptr)
+      {}
+
+      explicit AttributeIterator(const uint8_t* pos);
+
+      AttributeView operator*() const;
+
+      AttributeIterator& operator++();
+
+      AttributeIterator operator++(int);
+
+      bool operator==(const AttributeIterator& right) const { return pos_ == right.pos_; }
+
+      bool operator!=(const AttributeIterator& right) const { return pos_ != right.pos_; }
+
+    private:
+      const uint8_t* pos_;
+    };
+
+  public:
+    // throws radius_lite::Exception if the datagram is malformed
+    PacketView(const uint8_t* buffer, size_t size);
+
+    // same checks without exceptions: nullopt and ec set to radius_lite::Error if the datagram is malformed
+    static std::optional<PacketView>
+    parse(const uint8_t* buffer, size_t size, boost::system::error_code& ec);
+
+    uint8_t type() const { return buffer_[0]; }
+
+    uint8_t id() const { return buffer_[1]; }
+
+    // value of the Length field, bytes after it are padding and ignored
+    size_t length() const { return length_; }
+
+    Auth auth() const;
+
+    const uint8_t* data() const { return buffer_; }
+
+    // iterates all attributes (including Vendor-Specific) in wire order
+    AttributeIterator begin() const;
+
+    AttributeIterator end() const;
+
+    size_t attributes_count() const { return attributes_count_; }
+
+    size_t vendor_attributes_count() const { return vendor_attributes_count_; }
+
+    // first occurrence of standard attribute
+    std::optional<ByteSpan> find_attribute(uint8_t type) const;
+
+    // first occurrence of vendor attribute
+    std::optional<ByteSpan> find_vendor_attribute(uint32_t vendor_id, uint8_t vendor_type) const;
+
+    // decodes Vendor-Specific attribute payload, attribute should be got from this view
+    static VendorAttributeView vendor_attribute(const AttributeView& attribute);
+
+    bool has_message_authenticator() const { return message_authenticator_offset_ != 0; }
+
+    // checks Message-Authenticator HMAC, false if the attribute is absent,
+    // request_auth: authenticator of the request (header authenticator for Access-Request)
+    bool check_message_authenticator(const SecretContext& secret, const Auth& request_auth) const;
+
+  private:
+    // framing isn't checked, check_ should be called
+    explicit PacketView(const uint8_t* buffer);
+
+    Error check_(size_t size);
+
+  private:
+    const uint8_t* buffer_;
+    size_t length_;
+    size_t attributes_count_;
+    size_t vendor_attributes_count_;
+    // offset of the first Message-Authenticator value, 0 if there is no attribute
+    size_t message_authenticator_offset_;
+  };
+}
+
+namespace radius_lite
+{
+  inline
+  PacketView::AttributeIterator::AttributeIterator(const uint8_t* pos)
+    : pos_(pos)
+  {}
+
+  inline PacketView::AttributeView
+  PacketView::AttributeIterator::operator*() const
+  {
+    return AttributeView{pos_[0], ByteSpan(pos_ + 2, pos_[1] - 2)};
+  }
+
+  inline PacketView::AttributeIterator&
+  PacketView::AttributeIterator::operator++()
+  {
+    pos_ += pos_[1];
+    return *this;
+  }
+
+  inline PacketView::AttributeIterator
+  PacketView::AttributeIterator::operator++(int)
+  {
+    AttributeIterator result(*this);
+    ++*this;
+    return result;
+  }
+
+  inline PacketView::AttributeIterator
+  PacketView::begin() const
+  {
+    return AttributeIterator(buffer_ + 20);
+  }
+
+  inline PacketView::AttributeIterator
+  PacketView::end() const
+  {
+    return AttributeIterator(buffer_ + length_);
+  }
+}
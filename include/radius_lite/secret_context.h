@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint> //uint8_t, uint32_t
+#include <string>
+
+#include <openssl/md5.h>
+
+namespace radius_lite
+{
+  // Shared secret of a RADIUS client with the MD5 state after absorbing it.
+  // Built once per client, password blocks hash only the remaining 16 bytes.
+  // Construction hashes the secret, so it isn't implicit: keep one context per client.
+  class SecretContext
+  {
+  public:
+    SecretContext();
+
+    explicit SecretContext(std::string secret);
+
+    explicit SecretContext(const char* secret);
+
+    const std::string& secret() const { return secret_; }
+
+    // MD5 state of the secret, continue it with MD5_Update on a copy
+    const MD5_CTX& md5() const { return md5_; }
+
+    // HMAC-MD5 keyed with the secret: state after absorbing key xor ipad,
+    // continue it with MD5_Update on a copy and pass to hmac_final
+    const MD5_CTX& hmac_inner() const { return hmac_inner_; }
+
+    // completes HMAC-MD5 of the message hashed into inner, writes 16 bytes digest
+    void hmac_final(MD5_CTX& inner, uint8_t* digest) const;
+
+    bool operator==(const SecretContext& right) const { return secret_ == right.secret_; }
+
+    bool operator!=(const SecretContext& right) const { return !(*this == right); }
+
+  private:
+    std::string secret_;
+    MD5_CTX md5_;
+    MD5_CTX hmac_inner_;
+    MD5_CTX hmac_outer_;
+  };
+}
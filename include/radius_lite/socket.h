@@ -1,55 +1,276 @@
 #pragma once
 
+#include <sys/socket.h> //mmsghdr
+#include <sys/uio.h> //iovec
+
 #include "packet.h"
+#include "packet_buffer.h"
+#include "packet_view.h"
 #include <boost/asio.hpp>
 #include <cstdint> //uint8_t, uint32_t
 #include <array>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <type_traits>
+#include <vector>
 
 namespace radius_lite
 {
+  class IoUringTransport;
+
   class Socket
   {
   public:
+    enum class Transport
+    {
+      // Boost.Asio reactor (epoll), optionally batched with recvmmsg/sendmmsg
+      ASIO,
+      // multishot recvmsg into provided buffers and batched sendmsg (Linux 6.0),
+      // falls back to ASIO if the kernel doesn't support it
+      IO_URING
+    };
+
+    // packet is handed over to the handler, it can be moved out
+    // to finish the request asynchronously without copying attributes
     using PacketProcessFun = std::function<void(
       const boost::system::error_code&,
-      const std::optional<Packet>&,
+      std::optional<Packet>&&,
+      const boost::asio::ip::udp::endpoint&)>;
+
+    // view points into the socket receive buffer and is valid only during the call,
+    // handler should build Packet (or copy the bytes) if it needs the request later
+    using PacketViewProcessFun = std::function<void(
+      const boost::system::error_code&,
+      const std::optional<PacketView>&,
       const boost::asio::ip::udp::endpoint&)>;
 
+    // what asyncSend does with a response when the send queue is full,
+    // the dropped response callback gets boost::asio::error::no_buffer_space
+    enum class SendDropPolicy
+    {
+      DROP_NEWEST,
+      DROP_OLDEST
+    };
+
+    // socket calls and datagrams since construction, read them from the io_service thread
+    struct IoStats
+    {
+      // async_receive_from completions, recvmmsg calls or io_uring wakeups
+      uint64_t receive_calls = 0;
+      uint64_t received = 0;
+      // received datagrams that aren't valid packets, reported to the callback with the parse error
+      uint64_t parse_errors = 0;
+      // send_to, sendmmsg or io_uring_enter calls
+      uint64_t send_calls = 0;
+      uint64_t sent = 0;
+      // responses queued because the socket wasn't writable (or batched) and dropped on queue overflow
+      uint64_t send_queued = 0;
+      uint64_t send_dropped = 0;
+      // failed io_uring_enter calls and eventfd reads of the io_uring transport
+      uint64_t transport_errors = 0;
+    };
+
   public:
+    // reuse_port: bind with SO_REUSEPORT, the kernel spreads datagrams
+    // between sockets bound to the same port (see SocketGroup),
+    // transport: see transport() for the one that is actually used
+    Socket(
+      boost::asio::io_service& io_service,
+      const SecretContext& secret,
+      uint16_t port,
+      const PacketProcessFun& callback,
+      bool reuse_port = false,
+      Transport transport = Transport::ASIO);
+
+    // selected for handlers that accept only PacketView,
+    // handlers that accept Packet (or generic lambdas) use the constructor above
+    template<
+      typename ViewProcessFun,
+      typename = std::enable_if_t<
+        std::conjunction_v<
+          std::negation<std::is_invocable<
+            ViewProcessFun,
+            const boost::system::error_code&,
+            std::optional<Packet>&&,
+            const boost::asio::ip::udp::endpoint&>>,
+          std::is_invocable<
+            ViewProcessFun,
+            const boost::system::error_code&,
+            const std::optional<PacketView>&,
+            const boost::asio::ip::udp::endpoint&>>>>
     Socket(
       boost::asio::io_service& io_service,
-      const std::string& secret,
+      const SecretContext& secret,
       uint16_t port,
-      const PacketProcessFun& callback);
+      ViewProcessFun callback,
+      bool reuse_port = false,
+      Transport transport = Transport::ASIO);
 
+    ~Socket();
+
+    // on the io_service thread the response is sent at once with non-blocking send_to
+    // and callback is called before asyncSend returns; it is queued (see set_send_queue_limit)
+    // only if the socket isn't writable, other threads post the response to the io_service thread;
+    // response is encoded into a pooled buffer, throws if it is longer than PacketBuffer::CAPACITY
     void asyncSend(
       const Packet& response,
       const boost::asio::ip::udp::endpoint& destination,
       const std::function<void(const boost::system::error_code&)>& callback);
 
+    // sends an encoded datagram as is (forwarded request, prebuilt response),
+    // the reference is dropped when the send completes
+    void asyncSend(
+      PacketBufferPtr datagram,
+      const boost::asio::ip::udp::endpoint& destination,
+      const std::function<void(const boost::system::error_code&)>& callback);
+
+    // buffer of the datagram passed to the running receive callback, null outside of it;
+    // holding it keeps PacketView bytes valid after the callback returns
+    // (io_uring transport copies the datagram into a pooled buffer on this call)
+    PacketBufferPtr received_buffer() const;
+
     void close(boost::system::error_code& ec);
 
+    // attribute classes of decoded packets, table should outlive the socket
+    void set_decode_table(const AttributeDecodeTable& decode_table);
+
+    Transport transport() const;
+
+    // bound of responses waiting for a writable socket (1024 by default),
+    // call it before run() or from the io_service thread
+    void set_send_queue_limit(size_t limit, SendDropPolicy policy = SendDropPolicy::DROP_NEWEST);
+
+    // asio transport, batch_size > 1: when the socket becomes readable up to batch_size datagrams are read
+    // with one recvmmsg and responses queued by asyncSend are flushed with one sendmmsg,
+    // 1 (default) is a receive/send call per datagram; call it before run() or from the io_service thread.
+    // Ignored (always 1) if the library is built without recvmmsg/sendmmsg (RADIUS_LITE_MMSG)
+    void set_batch_size(size_t batch_size);
+
+    const IoStats& io_stats() const { return io_stats_; }
+
+  private:
+    struct ViewCallback_ {};
+
+    // target of both public constructors, members are constructed out of line
+    Socket(
+      ViewCallback_,
+      boost::asio::io_service& io_service,
+      const SecretContext& secret,
+      uint16_t port,
+      PacketViewProcessFun callback,
+      bool reuse_port,
+      Transport transport);
+
+    // decodes the view into an owning packet for handlers that accept Packet
+    static PacketViewProcessFun
+    decode_callback_(Socket& socket, const PacketProcessFun& callback);
+
+    static boost::asio::ip::udp::socket
+    open_(boost::asio::io_service& io_service, uint16_t port, bool reuse_port);
+
+    struct PendingSend_
+    {
+      PacketBufferPtr buffer;
+      boost::asio::ip::udp::endpoint destination;
+      std::function<void(const boost::system::error_code&)> callback;
+    };
+
   private:
-    void start_receive_loop_(const PacketProcessFun& callback);
+    void start_receive_loop_();
 
+    // owner: pooled buffer that holds the datagram, null if the datagram is in a transport buffer
     void handle_receive_(
       const boost::system::error_code& error,
+      const uint8_t* buffer,
       std::size_t bytes,
-      const PacketProcessFun& callback);
+      const boost::asio::ip::udp::endpoint& source,
+      PacketBuffer* owner);
 
     void handle_send_(
       const boost::system::error_code& ec,
       const std::function<void(const boost::system::error_code&)>& callback);
 
-    void order_receive_(const PacketProcessFun& callback);
+    // io_service thread part of asyncSend
+    void send_(
+      PacketBufferPtr&& datagram,
+      const boost::asio::ip::udp::endpoint& destination,
+      const std::function<void(const boost::system::error_code&)>& callback);
+
+    void enqueue_send_(
+      PacketBufferPtr&& datagram,
+      const boost::asio::ip::udp::endpoint& destination,
+      const std::function<void(const boost::system::error_code&)>& callback);
+
+    void wait_writable_();
+
+    void order_receive_();
+
+#ifdef RADIUS_LITE_MMSG
+    // reads datagrams until the socket would block, then waits for readability
+    void receive_batch_();
+#endif
+
+    // sends queued responses until the queue is empty or the socket would block
+    void flush_send_queue_();
 
   private:
     boost::asio::io_service& io_service_;
     boost::asio::ip::udp::socket socket_;
     boost::asio::ip::udp::endpoint remote_endpoint_;
-    std::array<uint8_t, 4096> recv_buffer_;
-    std::string secret_;
+    PacketBufferPtr recv_buffer_;
+    SecretContext secret_;
+    const AttributeDecodeTable* decode_table_;
+    PacketViewProcessFun callback_;
+    IoStats io_stats_;
+
+    // datagram of the running receive callback
+    const uint8_t* received_data_;
+    size_t received_size_;
+    PacketBuffer* received_owner_;
+
+    // batched mode, buffers are reused by every recvmmsg while handlers don't hold them
+    size_t batch_size_;
+#ifdef RADIUS_LITE_MMSG
+    std::vector<PacketBufferPtr> batch_buffers_;
+    std::vector<boost::asio::ip::udp::endpoint> batch_endpoints_;
+    std::vector<iovec> batch_iovecs_;
+    std::vector<mmsghdr> batch_messages_;
+#endif
+    // drops and completions remove from the front
+    std::deque<PendingSend_> send_queue_;
+    std::vector<PendingSend_> send_completed_;
+#ifdef RADIUS_LITE_MMSG
+    std::vector<iovec> send_iovecs_;
+    std::vector<mmsghdr> send_messages_;
+#endif
+    bool flush_ordered_;
+    size_t send_queue_limit_;
+    SendDropPolicy send_drop_policy_;
+
+    // set if io_uring transport is used, declared after socket_: destroyed before it
+    std::unique_ptr<IoUringTransport> io_uring_;
   };
 }
+
+namespace radius_lite
+{
+  template<typename ViewProcessFun, typename>
+  Socket::Socket(
+    boost::asio::io_service& io_service,
+    const SecretContext& secret,
+    uint16_t port,
+    ViewProcessFun callback,
+    bool reuse_port,
+    Transport transport)
+    : Socket(
+        ViewCallback_(),
+        io_service,
+        secret,
+        port,
+        PacketViewProcessFun(std::move(callback)),
+        reuse_port,
+        transport)
+  {}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "socket.h"
+#include <boost/asio.hpp>
+#include <atomic>
+#include <cstdint> //uint8_t, uint32_t
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace radius_lite
+{
+  // N SO_REUSEPORT sockets on one port, each with its own io_service, thread and buffers.
+  // The kernel hashes datagrams of a client to one shard, so requests are processed
+  // on all shards in parallel; callback is called from shard threads and should be thread safe.
+  class SocketGroup
+  {
+  public:
+    struct ShardStats
+    {
+      // decoded packets handed to callback
+      uint64_t received = 0;
+      // receive errors and malformed datagrams
+      uint64_t errors = 0;
+      // responses passed to asyncSend
+      uint64_t sent = 0;
+    };
+
+  public:
+    // shards are bound and their threads started here, throws boost::system::system_error
+    // if the port can't be bound or std::system_error if a thread can't be started; pin_threads binds shard i thread to CPU i (modulo CPU count)
+    SocketGroup(
+      const SecretContext& secret,
+      uint16_t port,
+      const Socket::PacketProcessFun& callback,
+      size_t shards_count = std::thread::hardware_concurrency(),
+      bool pin_threads = false);
+
+    // stops and joins shard threads
+    ~SocketGroup();
+
+    SocketGroup(const SocketGroup&) = delete;
+    SocketGroup& operator=(const SocketGroup&) = delete;
+
+    size_t size() const { return shards_.size(); }
+
+    // sends from the shard of the calling thread (the one that received the request),
+    // from the first shard if it isn't called from a shard thread
+    void asyncSend(
+      const Packet& response,
+      const boost::asio::ip::udp::endpoint& destination,
+      const std::function<void(const boost::system::error_code&)>& callback);
+
+    void asyncSend(
+      PacketBufferPtr datagram,
+      const boost::asio::ip::udp::endpoint& destination,
+      const std::function<void(const boost::system::error_code&)>& callback);
+
+    // Socket::received_buffer of the calling shard thread, null if it isn't called from a shard callback
+    PacketBufferPtr received_buffer() const;
+
+    // applied on every shard thread, table should outlive the group
+    void set_decode_table(const AttributeDecodeTable& decode_table);
+
+    // recvmmsg/sendmmsg batches of every shard (see Socket::set_batch_size)
+    void set_batch_size(size_t batch_size);
+
+    // stops receiving, callbacks that are running are finished by stop
+    void stop();
+
+    std::vector<ShardStats> stats() const;
+
+  private:
+    struct Shard
+    {
+      boost::asio::io_service io_service;
+      std::unique_ptr<Socket> socket;
+      std::thread thread;
+      std::atomic<uint64_t> received{0};
+      std::atomic<uint64_t> errors{0};
+      std::atomic<uint64_t> sent{0};
+    };
+
+  private:
+    void run_(size_t index, bool pin_thread);
+
+    // stops io_services and joins the shard threads that were started
+    void join_();
+
+    Shard& current_shard_();
+
+  private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+  };
+}
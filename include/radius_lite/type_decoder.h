@@ -1,6 +1,7 @@
 #pragma once
 
 #include "attribute.h"
+#include "dictionaries.h"
 
 namespace radius_lite
 {
@@ -15,21 +16,26 @@ namespace radius_lite
       const std::string& secret,
       const std::array<uint8_t, 16>& auth) const;
 
+    // type is resolved by Dictionaries::get_attribute_value_type, decode is an indexed call,
+    // null if size doesn't fit an integer or address type; doesn't throw
+    AttributePtr decode(
+      unsigned int attribute_id,
+      AttributeValueType type,
+      const uint8_t* data,
+      size_t size) const;
+
     static const TypeDecoder& instance();
 
   private:
-    using BaseTypeDecoder = std::function<
-      radius_lite::AttributePtr(
-        unsigned int attribute_id,
-        const uint8_t* data,
-        size_t size,
-        const std::string& secret,
-        const std::array<uint8_t, 16>& auth)>;
+    using BaseTypeDecoder = AttributePtr (*)(
+      unsigned int attribute_id,
+      const uint8_t* data,
+      size_t size);
 
   private:
     TypeDecoder();
 
   private:
-    std::unordered_map<std::string, BaseTypeDecoder> base_type_decoders_;
+    std::array<BaseTypeDecoder, static_cast<size_t>(AttributeValueType::UINT64) + 1> base_type_decoders_;
   };
 }
@@ -1,10 +1,41 @@
 #pragma once
 
 #include <array>
+#include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace radius_lite
 {
   using Auth = std::array<uint8_t, 16>;
   using ByteArray = std::vector<uint8_t>;
+
+  // non-owning view of a contiguous byte range (received buffer, attribute value)
+  class ByteSpan
+  {
+  public:
+    ByteSpan()
+      : data_(nullptr), size_(0)
+    {}
+
+    ByteSpan(const uint8_t* data, size_t size)
+      : data_(data), size_(size)
+    {}
+
+    const uint8_t* data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    const uint8_t* begin() const { return data_; }
+
+    const uint8_t* end() const { return data_ + size_; }
+
+    uint8_t operator[](size_t index) const { return data_[index]; }
+
+  private:
+    const uint8_t* data_;
+    size_t size_;
+  };
 }
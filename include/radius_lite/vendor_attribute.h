@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <memory_resource>
 #include <cstdint> //uint8_t, uint32_t
 
 #include "types.h"
@@ -11,7 +12,9 @@ namespace radius_lite
   class VendorSpecific
   {
   public:
-    VendorSpecific(const uint8_t* data);
+    VendorSpecific(
+      const uint8_t* data,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     VendorSpecific(uint32_t vendorId, uint8_t vendorType, const std::vector<uint8_t>& vendorValue);
 
@@ -23,11 +26,20 @@ namespace radius_lite
 
     std::vector<uint8_t> toVector() const;
 
-    const ByteArray& data() const;
+    // size of the encoded Vendor-Specific attribute with vendor id and vendor header
+    size_t encoded_size() const { return 8 + m_value.size(); }
+
+    // writes encoded_size() bytes into buffer, returns number of written bytes
+    size_t encode(uint8_t* buffer) const;
+
+    ByteArray data() const;
+
+    // vendor attribute value without copy, valid while this object is alive
+    ByteSpan value() const { return ByteSpan(m_value.data(), m_value.size()); }
 
   private:
     uint32_t m_vendorId;
     uint8_t m_vendorType;
-    std::vector<uint8_t> m_value;
+    std::pmr::vector<uint8_t> m_value;
   };
 }
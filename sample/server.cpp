@@ -3,10 +3,35 @@
 
 #include "server.h"
 #include "packet_codes.h"
-#include "packet_reader.h"
+#include "extraction_plan.h"
 
 using boost::system::error_code;
 
+namespace
+{
+  // attributes printed for every request, the plan is compiled once from this list
+  const std::vector<radius_lite::ExtractionPlan::Field> EXTRACTED_FIELDS {
+    {"Calling-Station-Id", ""},
+    {"Called-Station-Id", ""},
+    {"Framed-IP-Address", ""},
+    {"NAS-IP-Address", ""},
+    {"Acct-Status-Type", ""},
+    {"IMSI", "3GPP"},
+    {"IMEISV", "3GPP"},
+    {"RAT-Type", "3GPP"},
+    {"SGSN-MCC-MNC", "3GPP"},
+    {"MS-TimeZone", "3GPP"},
+    {"SGSN-Address", "3GPP"},
+    {"CG-Address", "3GPP"},
+    {"Charging-ID", "3GPP"},
+    {"GPRS-Negotiated-QoS-profile", "3GPP"},
+    {"User-Location-Info", "3GPP"},
+    {"NSAPI", "3GPP"},
+    {"Selection-Mode", "3GPP"},
+    {"Charging-Characteristics", "3GPP"}
+  };
+}
+
 Server::Server(
   boost::asio::io_service& io_service,
   const std::string& secret,
@@ -14,43 +39,91 @@ Server::Server(
   const std::string& filePath)
   : m_radius(
       io_service,
-      secret,
+      radius_lite::SecretContext(secret),
       port,
-      [this](const auto& error, const auto& packet, const boost::asio::ip::udp::endpoint& source)
+      [this](
+        const error_code& error,
+        std::optional<radius_lite::Packet>&& packet,
+        const boost::asio::ip::udp::endpoint& source)
       {
-        handle_receive(error, packet, source);
+        handle_receive(error, std::move(packet), source);
       }
     ),
-    m_dictionaries(filePath),
-    secret_(secret)
+    io_service_(io_service),
+    dictionaries_(filePath),
+    dictionaries_reader_(dictionaries_),
+    secret_(secret),
+    reload_signals_(io_service, SIGHUP),
+    reloading_(false)
 {
-  m_dictionaries.resolve(); // TODO: make this in Dictionaries c-tor, but use other class for included dictionaries
+  decode_table_ = radius_lite::AttributeDecodeTable(dictionaries_reader_.dictionaries());
+  m_radius.set_decode_table(decode_table_);
+  extraction_plan_ = std::make_unique<radius_lite::ExtractionPlan>(
+    dictionaries_reader_.dictionaries(),
+    EXTRACTED_FIELDS);
+  wait_reload_signal();
   std::cout << "To start receive" << std::endl;
 }
 
-std::string ipv4_address_to_string(uint32_t ipv4)                                                                                                        
-{                                                                                                                                                        
-  return std::to_string(ipv4 & 0xFF) + "." +                                                                                                             
-    std::to_string((ipv4 >> 8) & 0xFF) + "." +                                                                                                           
-    std::to_string((ipv4 >> 16) & 0xFF) + "." +                                                                                                          
-    std::to_string((ipv4 >> 24) & 0xFF)                                                                                                                  
-    ;                                                                                                                                                    
+Server::~Server()
+{
+  if (reload_thread_.joinable())
+  {
+    reload_thread_.join();
+  }
 }
 
-std::string
-print_uint_attr(
-  radius_lite::PacketReader& packet_reader,
-  const std::string& attr_name,
-  const std::string& vendor_name = std::string())
+void Server::wait_reload_signal()
 {
-  auto attr = packet_reader.get_attribute_by_name(attr_name, vendor_name);
-  if (!attr)
+  reload_signals_.async_wait(
+    [this](const error_code& error, int /*signal_number*/)
+    {
+      if (error)
+      {
+        return;
+      }
+
+      // a reload in progress already picks up the latest files
+      if (!reloading_.exchange(true))
+      {
+        if (reload_thread_.joinable())
+        {
+          reload_thread_.join();
+        }
+
+        reload_thread_ = std::thread(
+          [this]()
+          {
+            try
+            {
+              dictionaries_.reload();
+              std::cout << "Dictionaries reloaded" << std::endl;
+
+              // switched between requests on the io_service thread, so a request
+              // is decoded and extracted with the same dictionaries
+              io_service_.post([this]() { update_dictionaries(); });
+            }
+            catch (const std::exception& e)
+            {
+              std::cout << "Dictionaries reload failed, keep previous: " << e.what() << std::endl;
+            }
+
+            reloading_ = false;
+          });
+      }
+
+      wait_reload_signal();
+    });
+}
+
+void Server::update_dictionaries()
+{
+  if (dictionaries_reader_.update())
   {
-    return attr_name + ": no attribute in dictionary";
+    const auto& dictionaries = *dictionaries_reader_.snapshot();
+    decode_table_ = radius_lite::AttributeDecodeTable(dictionaries);
+    extraction_plan_ = std::make_unique<radius_lite::ExtractionPlan>(dictionaries, EXTRACTED_FIELDS);
   }
-
-  auto attr_s = attr->as_uint();
-  return attr_name + ": " + (attr_s.has_value() ? std::to_string(*attr_s) : "none");
 }
 
 std::string byteToHex(uint8_t byte)
@@ -60,55 +133,38 @@ std::string byteToHex(uint8_t byte)
 }
 
 std::string
-print_ipv4_attr(
-  radius_lite::PacketReader& packet_reader,
+print_value(
   const std::string& attr_name,
-  const std::string& vendor_name = std::string())
+  const radius_lite::ExtractionPlan::Value& value)
 {
-  auto attr = packet_reader.get_attribute_by_name(attr_name, vendor_name);
-  if (!attr)
+  using Type = radius_lite::AttributeValueType;
+
+  if (!value.present)
   {
-    return attr_name + ": no attribute in dictionary";
+    return attr_name + ": none";
   }
 
-  auto attr_s = attr->as_uint();
-  return attr_name + ": " + (attr_s.has_value() ?
-    ipv4_address_to_string(*attr_s) + "(" + std::to_string(*attr_s) + ")" :
-    "none");
-}
-
-std::string
-print_string_attr(
-  radius_lite::PacketReader& packet_reader,
-  const std::string& attr_name,
-  const std::string& vendor_name = std::string())
-{
-  auto attr = packet_reader.get_attribute_by_name(attr_name, vendor_name);
-  if (!attr)
+  if (value.type == Type::BYTE || value.type == Type::UINT16 || value.type == Type::INTEGER ||
+    value.type == Type::UINT32 || value.type == Type::UINT64)
   {
-    return attr_name + ": no attribute in dictionary";
+    return attr_name + ": " + std::to_string(value.integer);
   }
 
-  auto attr_s = attr->as_string();
-  return attr_name + ": " + (attr_s.has_value() ? *attr_s : "none");
-}
+  if (value.type == Type::IPADDR)
+  {
+    const auto& o = value.octets;
+    return attr_name + ": " + std::to_string(o[0]) + "." + std::to_string(o[1]) + "." +
+      std::to_string(o[2]) + "." + std::to_string(o[3]);
+  }
 
-std::string
-print_octets_attr(
-  radius_lite::PacketReader& packet_reader,
-  const std::string& attr_name,
-  const std::string& vendor_name = std::string())
-{
-  auto attr = packet_reader.get_attribute_by_name(attr_name, vendor_name);
-  if (!attr)
+  if (value.type == Type::STRING)
   {
-    return attr_name + ": no attribute in dictionary";
+    return attr_name + ": " + std::string(value.octets.begin(), value.octets.end());
   }
 
-  auto attr_s = attr->as_octets();
   std::string res = attr_name + ":";
 
-  for (const auto& b : attr_s)
+  for (const auto& b : value.octets)
   {
     res += " " + byteToHex(b);
   }
@@ -118,44 +174,34 @@ print_octets_attr(
 
 radius_lite::Packet Server::make_response(const radius_lite::Packet& request)
 {
-  radius_lite::PacketReader packet_reader(request, m_dictionaries, secret_);
-  std::cout << print_string_attr(packet_reader, "Calling-Station-Id") << std::endl;
-  std::cout << print_string_attr(packet_reader, "Called-Station-Id") << std::endl;
-  std::cout << print_ipv4_attr(packet_reader, "Framed-IP-Address") << std::endl;
-  std::cout << print_ipv4_attr(packet_reader, "NAS-IP-Address") << std::endl;
-  std::cout << print_uint_attr(packet_reader, "Acct-Status-Type") << std::endl;
-  std::cout << print_string_attr(packet_reader, "IMSI", "3GPP") << std::endl;
-  std::cout << print_string_attr(packet_reader, "IMEISV", "3GPP") << std::endl;
-  std::cout << print_uint_attr(packet_reader, "RAT-Type", "3GPP") << std::endl;
-  std::cout << print_string_attr(packet_reader, "SGSN-MCC-MNC", "3GPP") << std::endl;
-
-  // MS-TimeZone struct => TZ (2 bytes)
+  const radius_lite::DictionaryLookup& dictionaries = *dictionaries_reader_.snapshot();
+
+  std::vector<radius_lite::ExtractionPlan::Value> values(extraction_plan_->size());
+  extraction_plan_->extract(request, values.data());
+
+  for (size_t i = 0; i < values.size(); ++i)
   {
-    auto attr = packet_reader.get_attribute_by_name("MS-TimeZone", "3GPP");
-    if (attr)
+    const auto& field = EXTRACTED_FIELDS[i];
+
+    // MS-TimeZone struct => TZ (2 bytes)
+    if (field.name == "MS-TimeZone")
     {
-      auto attr_s = attr->as_octets();
-      if (attr_s.size() > 0)
+      if (values[i].present && values[i].octets.size() > 0)
       {
-        std::cout << "MS-TimeZone: " << static_cast<unsigned int>(attr_s[0]) << std::endl;
+        std::cout << "MS-TimeZone: " << static_cast<unsigned int>(values[i].octets[0]) << std::endl;
       }
+
+      continue;
     }
+
+    std::cout << print_value(field.name, values[i]) << std::endl;
   }
-  //std::cout << print_octets_attr(packet_reader, "MS-TimeZone", "3GPP") << std::endl;
-  std::cout << print_ipv4_attr(packet_reader, "SGSN-Address", "3GPP") << std::endl;
-  std::cout << print_ipv4_attr(packet_reader, "CG-Address", "3GPP") << std::endl;
-  std::cout << print_uint_attr(packet_reader, "Charging-ID", "3GPP") << std::endl;
-  std::cout << print_string_attr(packet_reader, "GPRS-Negotiated-QoS-profile", "3GPP") << std::endl;
-  std::cout << print_octets_attr(packet_reader, "User-Location-Info", "3GPP") << std::endl;
-  std::cout << print_string_attr(packet_reader, "NSAPI", "3GPP") << std::endl;
-  std::cout << print_string_attr(packet_reader, "Selection-Mode", "3GPP") << std::endl;
-  std::cout << print_string_attr(packet_reader, "Charging-Characteristics", "3GPP") << std::endl;
 
   /*
   for (const auto& vendor_v : request.vendorSpecific())
   {
-    auto vendor_name = m_dictionaries.vendorNames().name(vendor_v.vendorId());
-    auto vendor_attr_name = m_dictionaries.vendorAttributes().name(vendor_name, vendor_v.vendorType());
+    auto vendor_name = dictionaries.vendorNames().name(vendor_v.vendorId());
+    auto vendor_attr_name = dictionaries.vendorAttributes().name(vendor_name, vendor_v.vendorType());
 
     std::cout << "vendorSpecific: vendorId = " << vendor_v.vendorId() <<
       ", vendorType = " << static_cast<int>(vendor_v.vendorType()) <<
@@ -165,19 +211,19 @@ radius_lite::Packet Server::make_response(const radius_lite::Packet& request)
   */
 
   std::vector<radius_lite::Attribute*> attributes;
-  attributes.push_back(new radius_lite::String(m_dictionaries.attributeCode("User-Name"), "test"));
-  attributes.push_back(new radius_lite::Integer<uint32_t>(m_dictionaries.attributeCode("NAS-Port"), 20));
+  attributes.push_back(new radius_lite::String(dictionaries.find_attribute_code("User-Name").value(), "test"));
+  attributes.push_back(new radius_lite::Integer<uint32_t>(dictionaries.find_attribute_code("NAS-Port").value(), 20));
   std::array<uint8_t, 4> address {127, 104, 22, 17};
-  attributes.push_back(new radius_lite::IpAddress(m_dictionaries.attributeCode("NAS-IP-Address"), address));
+  attributes.push_back(new radius_lite::IpAddress(dictionaries.find_attribute_code("NAS-IP-Address").value(), address));
   std::vector<uint8_t> bytes {'1', '2', '3', 'a', 'b', 'c'};
-  attributes.push_back(new radius_lite::Bytes(m_dictionaries.attributeCode("Callback-Number"), bytes));
+  attributes.push_back(new radius_lite::Bytes(dictionaries.find_attribute_code("Callback-Number").value(), bytes));
   std::vector<uint8_t> chapPassword {'1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 'g' };
-  attributes.push_back(new radius_lite::ChapPassword(m_dictionaries.attributeCode("CHAP-Password"), 1, chapPassword));
+  attributes.push_back(new radius_lite::ChapPassword(dictionaries.find_attribute_code("CHAP-Password").value(), 1, chapPassword));
 
   std::vector<radius_lite::VendorSpecific> vendorSpecific;
   /*
   std::vector<uint8_t> vendorValue {0, 0, 0, 3};
-  vendorSpecific.push_back(radius_lite::VendorSpecific(m_dictionaries.vendorCode("Dlink"), m_dictionaries.vendorAttributeCode("Dlink", "Dlink-User-Level"), vendorValue));
+  vendorSpecific.push_back(radius_lite::VendorSpecific(dictionaries.vendorCode("Dlink"), dictionaries.vendorAttributeCode("Dlink", "Dlink-User-Level"), vendorValue));
   */
 
   if (request.type() == radius_lite::ACCESS_REQUEST)
@@ -198,7 +244,7 @@ void Server::handle_send(const error_code& ec)
 
 void Server::handle_receive(
   const error_code& error,
-  const std::optional<radius_lite::Packet>& packet,
+  std::optional<radius_lite::Packet>&& packet,
   const boost::asio::ip::udp::endpoint& source)
 {
   if (error)
@@ -3,7 +3,12 @@
 #include "socket.h"
 #include "packet.h"
 #include "dictionaries.h"
+#include "dictionary_registry.h"
+#include "extraction_plan.h"
 #include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <optional>
 #include <cstdint> //uint8_t, uint32_t
 
@@ -16,12 +21,21 @@ public:
     uint16_t port,
     const std::string& filePath);
 
+  ~Server();
+
 private:
+  // SIGHUP reloads dictionaries on a separate thread, requests keep using the current snapshot
+  void wait_reload_signal();
+
+  // rebuilds decode table and extraction plan when a new snapshot was published,
+  // posted by the reload thread to run on the io_service thread
+  void update_dictionaries();
+
   radius_lite::Packet make_response(const radius_lite::Packet& request);
 
   void handle_receive(
     const boost::system::error_code& error,
-    const std::optional<radius_lite::Packet>& packet,
+    std::optional<radius_lite::Packet>&& packet,
     const boost::asio::ip::udp::endpoint& source);
 
   void handle_send(const boost::system::error_code& ec);
@@ -30,6 +44,13 @@ private:
 
 private:
   radius_lite::Socket m_radius;
-  radius_lite::Dictionaries m_dictionaries;
-  std::string secret_;
+  boost::asio::io_service& io_service_;
+  radius_lite::DictionaryRegistry dictionaries_;
+  radius_lite::DictionaryRegistry::Reader dictionaries_reader_;
+  radius_lite::AttributeDecodeTable decode_table_;
+  std::unique_ptr<radius_lite::ExtractionPlan> extraction_plan_;
+  radius_lite::SecretContext secret_;
+  boost::asio::signal_set reload_signals_;
+  std::atomic<bool> reloading_;
+  std::thread reload_thread_;
 };
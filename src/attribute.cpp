@@ -4,6 +4,7 @@
 #include "error.h"
 #include <openssl/md5.h>
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 
 namespace radius_lite
@@ -13,22 +14,34 @@ namespace radius_lite
   {}
 
   // String impl
-  String::String(uint8_t type, const uint8_t* data, size_t size)
+  String::String(
+    uint8_t type,
+    const uint8_t* data,
+    size_t size,
+    std::pmr::memory_resource* resource)
     : Attribute(type),
-      m_value(reinterpret_cast<const char*>(data), size)
+      m_value(reinterpret_cast<const char*>(data), size, resource)
   {}
 
   String::String(uint8_t type, const std::string& string)
     : Attribute(type),
-      m_value(string)
+      m_value(string.data(), string.size())
   {}
 
   ByteArray
-  String::data(const std::string& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
+  String::data(const SecretContext& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
   {
     return ByteArray(m_value.begin(), m_value.end());
   }
 
+  size_t String::encode(uint8_t* buffer, const SecretContext& /*secret*/, const Auth& /*auth*/) const
+  {
+    buffer[0] = type();
+    buffer[1] = 2 + m_value.size();
+    std::copy(m_value.begin(), m_value.end(), buffer + 2);
+    return 2 + m_value.size();
+  }
+
   String* String::clone() const
   {
     return new String(*this);
@@ -65,20 +78,28 @@ namespace radius_lite
   IpAddress::as_uint() const
   {
     return (
-      (static_cast<uint32_t>(m_value[3]) << 24) |
-      (static_cast<uint32_t>(m_value[2]) << 16) |
-      (static_cast<uint32_t>(m_value[1]) << 8) |
-      static_cast<uint32_t>(m_value[0]));
+      (static_cast<uint32_t>(m_value[0]) << 24) |
+      (static_cast<uint32_t>(m_value[1]) << 16) |
+      (static_cast<uint32_t>(m_value[2]) << 8) |
+      static_cast<uint32_t>(m_value[3]));
   }
 
   ByteArray
-  IpAddress::data(const std::string& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
+  IpAddress::data(const SecretContext& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
   {
     std::vector<uint8_t> result(4);
     std::copy(m_value.begin(), m_value.end(), result.begin());
     return result;
   }
 
+  size_t IpAddress::encode(uint8_t* buffer, const SecretContext& /*secret*/, const Auth& /*auth*/) const
+  {
+    buffer[0] = type();
+    buffer[1] = 2 + m_value.size();
+    std::copy(m_value.begin(), m_value.end(), buffer + 2);
+    return 2 + m_value.size();
+  }
+
   IpAddress* IpAddress::clone() const
   {
     return new IpAddress(*this);
@@ -89,88 +110,164 @@ namespace radius_lite
     uint8_t type,
     const uint8_t* data,
     size_t size,
-    const std::string& secret,
-    const std::array<uint8_t, 16>& auth)
-    : Attribute(type)
+    const SecretContext& secret,
+    const std::array<uint8_t, 16>& auth,
+    std::pmr::memory_resource* resource)
+    : Attribute(type),
+      m_ciphertext(data, data + size, resource),
+      m_secretMd5(secret.md5()),
+      m_auth(auth),
+      m_decrypted(false),
+      m_value(resource)
   {
     if (size > 128)
     {
       throw radius_lite::Exception(radius_lite::Error::invalidAttributeSize);
     }
+  }
 
-    std::vector<uint8_t> mdBuffer(auth.size() + secret.length());
-
-    std::copy(secret.begin(), secret.end(), mdBuffer.begin());
-    std::copy(auth.begin(), auth.end(), mdBuffer.begin() + secret.length());
+  Encrypted::Encrypted(uint8_t type, const std::string& password)
+    : Attribute(type),
+      m_secretMd5{},
+      m_auth{},
+      m_decrypted(true),
+      m_value(password.data(), password.size())
+  {}
 
-    std::vector<uint8_t> plaintext(size);
+  size_t Encrypted::decrypt_(std::array<uint8_t, 128>& plaintext) const
+  {
+    // b(i) = MD5(secret + c(i-1)), c(0) = request authenticator
+    const uint8_t* data = m_ciphertext.data();
+    const size_t size = m_ciphertext.size() / 16 * 16;
+    const uint8_t* prev = m_auth.data();
 
     for (size_t i = 0; i < size / 16; ++i)
     {
       std::array<uint8_t, 16> md;
 
-      MD5(mdBuffer.data(), mdBuffer.size(), md.data());
+      MD5_CTX context = m_secretMd5;
+      MD5_Update(&context, prev, 16);
+      MD5_Final(md.data(), &context);
+
       for (size_t j = 0; j < 16; ++j)
       {
         plaintext[i * 16 + j] = data[i * 16 + j] ^ md[j];
       }
 
-      for (size_t j = 0; j < 16; ++j)
-      {
-        mdBuffer[j + secret.length()] = data[i * 16 + j];
-      }
+      prev = data + i * 16;
     }
 
-    m_value.assign(plaintext.begin(), std::find(plaintext.begin(), plaintext.end(), 0));
+    return std::find(plaintext.begin(), plaintext.begin() + size, 0) - plaintext.begin();
   }
 
-  Encrypted::Encrypted(uint8_t type, const std::string& password)
-    : Attribute(type),
-      m_value(password)
-  {}
+  const std::pmr::string& Encrypted::value_() const
+  {
+    if (!m_decrypted)
+    {
+      std::array<uint8_t, 128> plaintext;
+      const size_t length = decrypt_(plaintext);
+      m_value.assign(plaintext.begin(), plaintext.begin() + length);
+      m_decrypted = true;
+    }
 
-  ByteArray
-  Encrypted::data(const std::string& secret, const std::array<uint8_t, 16>& auth) const
+    return m_value;
+  }
+
+  bool Encrypted::password_equals(const char* password, size_t size) const
   {
-    std::string plaintext = m_value;
+    if (m_decrypted)
+    {
+      return m_value.size() == size && std::equal(m_value.begin(), m_value.end(), password);
+    }
+
+    std::array<uint8_t, 128> plaintext;
+    const size_t length = decrypt_(plaintext);
+
+    if (length != size)
+    {
+      return false;
+    }
 
-    if (plaintext.length() % 16 != 0)
+    // don't stop on the first mismatch
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; ++i)
     {
-      plaintext.append(16 - m_value.length() % 16, '\0');
+      diff |= plaintext[i] ^ static_cast<uint8_t>(password[i]);
     }
 
-    ByteArray mdBuffer(auth.size() + secret.length());
+    return diff == 0;
+  }
 
-    for (size_t i = 0; i < secret.length(); ++i)
+  size_t Encrypted::padded_size_() const
+  {
+    if (!m_ciphertext.empty())
     {
-      mdBuffer[i] = secret[i];
+      return m_ciphertext.size() / 16 * 16;
     }
 
-    for (size_t i = 0; i < auth.size(); ++i)
+    return (m_value.size() + 15) / 16 * 16;
+  }
+
+  size_t Encrypted::encrypt_(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const
+  {
+    const size_t size = padded_size_();
+
+    // received value re-encrypted with the same key: send ciphertext as is
+    if (m_ciphertext.size() == size &&
+      auth == m_auth &&
+      std::memcmp(&secret.md5(), &m_secretMd5, sizeof(m_secretMd5)) == 0)
+    {
+      std::copy(m_ciphertext.begin(), m_ciphertext.end(), buffer);
+      return size;
+    }
+
+    std::array<uint8_t, 128> decrypted;
+    const uint8_t* plaintext = reinterpret_cast<const uint8_t*>(m_value.data());
+    size_t length = m_value.size();
+
+    if (!m_decrypted)
     {
-      mdBuffer[i + secret.length()] = auth[i];
+      length = decrypt_(decrypted);
+      plaintext = decrypted.data();
     }
 
-    ByteArray res(plaintext.length());
-    auto it = std::next(res.begin());
+    // c(i) = p(i) xor MD5(secret + c(i-1)), c(0) = request authenticator
+    const uint8_t* prev = auth.data();
 
-    for (size_t i = 0; i < plaintext.length() / 16; ++i)
+    for (size_t i = 0; i < size / 16; ++i)
     {
       std::array<uint8_t, 16> md;
-      MD5(mdBuffer.data(), mdBuffer.size(), md.data());
 
-      for (size_t j = 0; j < md.size(); ++j)
-      {
-        *it++ = plaintext[i * 16 + j] ^ md[j];
-      }
+      MD5_CTX context = secret.md5();
+      MD5_Update(&context, prev, 16);
+      MD5_Final(md.data(), &context);
 
       for (size_t j = 0; j < 16; ++j)
       {
-        mdBuffer[j + secret.length()] = res[i * 16 + j];
+        const size_t pos = i * 16 + j;
+        buffer[pos] = (pos < length ? plaintext[pos] : 0) ^ md[j];
       }
+
+      prev = buffer + i * 16;
     }
 
-    return res;
+    return size;
+  }
+
+  ByteArray
+  Encrypted::data(const SecretContext& secret, const std::array<uint8_t, 16>& auth) const
+  {
+    ByteArray result(padded_size_());
+    encrypt_(result.data(), secret, auth);
+    return result;
+  }
+
+  size_t Encrypted::encode(uint8_t* buffer, const SecretContext& secret, const Auth& auth) const
+  {
+    const size_t size = encrypt_(buffer + 2, secret, auth);
+    buffer[0] = type();
+    buffer[1] = 2 + size;
+    return 2 + size;
   }
 
   Encrypted* Encrypted::clone() const
@@ -178,16 +275,18 @@ namespace radius_lite
     return new Encrypted(*this);
   }
 
-  Bytes::Bytes(uint8_t type, const uint8_t* data, size_t size)
+  Bytes::Bytes(
+    uint8_t type,
+    const uint8_t* data,
+    size_t size,
+    std::pmr::memory_resource* resource)
     : Attribute(type),
-      m_value(size)
-  {
-    std::copy(data, data + size, m_value.begin());
-  }
+      m_value(data, data + size, resource)
+  {}
 
   Bytes::Bytes(uint8_t type, const std::vector<uint8_t>& bytes)
     : Attribute(type),
-      m_value(bytes)
+      m_value(bytes.begin(), bytes.end())
   {}
 
   std::string Bytes::toString() const
@@ -203,9 +302,17 @@ namespace radius_lite
   }
 
   ByteArray
-  Bytes::data(const std::string& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
+  Bytes::data(const SecretContext& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
   {
-    return m_value;
+    return ByteArray(m_value.begin(), m_value.end());
+  }
+
+  size_t Bytes::encode(uint8_t* buffer, const SecretContext& /*secret*/, const Auth& /*auth*/) const
+  {
+    buffer[0] = type();
+    buffer[1] = 2 + m_value.size();
+    std::copy(m_value.begin(), m_value.end(), buffer + 2);
+    return 2 + m_value.size();
   }
 
   Bytes* Bytes::clone() const
@@ -214,9 +321,13 @@ namespace radius_lite
   }
 
   // ChapPassword impl
-  ChapPassword::ChapPassword(uint8_t type, const uint8_t* data, size_t size)
+  ChapPassword::ChapPassword(
+    uint8_t type,
+    const uint8_t* data,
+    size_t size,
+    std::pmr::memory_resource* resource)
     : Attribute(type),
-      m_value(size - 1)
+      m_value(resource)
   {
     if (size != 17)
     {
@@ -224,17 +335,13 @@ namespace radius_lite
     }
 
     m_chapId = data[0];
-
-    for (size_t i = 0; i < size - 1; ++i)
-    {
-      m_value[i] = data[i + 1];
-    }
+    m_value.assign(data + 1, data + size);
   }
 
   ChapPassword::ChapPassword(uint8_t type, uint8_t chapId, const std::vector<uint8_t>& chapValue)
     : Attribute(type),
       m_chapId(chapId),
-      m_value(chapValue)
+      m_value(chapValue.begin(), chapValue.end())
   {
   }
 
@@ -251,7 +358,7 @@ namespace radius_lite
   }
 
   ByteArray
-  ChapPassword::data(const std::string& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
+  ChapPassword::data(const SecretContext& /*secret*/, const std::array<uint8_t, 16>& /*auth*/) const
   {
     ByteArray result(m_value.size() + 1);
     result[0] = m_chapId;
@@ -259,6 +366,15 @@ namespace radius_lite
     return result;
   }
 
+  size_t ChapPassword::encode(uint8_t* buffer, const SecretContext& /*secret*/, const Auth& /*auth*/) const
+  {
+    buffer[0] = type();
+    buffer[1] = 3 + m_value.size();
+    buffer[2] = m_chapId;
+    std::copy(m_value.begin(), m_value.end(), buffer + 3);
+    return 3 + m_value.size();
+  }
+
   ChapPassword* ChapPassword::clone() const
   {
     return new ChapPassword(*this);
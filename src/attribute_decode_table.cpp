@@ -0,0 +1,68 @@
+#include "attribute_decode_table.h"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace radius_lite
+{
+  namespace
+  {
+    std::optional<AttributeDecodeTable::Kind> kindByTypeName(const std::string& typeName)
+    {
+      using Kind = AttributeDecodeTable::Kind;
+
+      static const std::unordered_map<std::string, Kind> kinds = {
+        {"string", Kind::STRING},
+        {"octets", Kind::BYTES},
+        {"encrypted", Kind::ENCRYPTED},
+        {"ipaddr", Kind::IP_ADDRESS},
+        {"byte", Kind::INTEGER8},
+        {"uint16", Kind::INTEGER16},
+        {"integer", Kind::INTEGER32},
+        {"uint32", Kind::INTEGER32},
+        {"date", Kind::INTEGER32},
+        {"uint64", Kind::INTEGER64},
+        {"integer64", Kind::INTEGER64}
+      };
+
+      auto it = kinds.find(typeName);
+      if (it != kinds.end())
+      {
+        return it->second;
+      }
+
+      return std::nullopt;
+    }
+  }
+
+  AttributeDecodeTable::AttributeDecodeTable(const DictionaryLookup& dictionaries)
+    : AttributeDecodeTable()
+  {
+    for (size_t type = 1; type < kinds_.size(); ++type)
+    {
+      // dictionaries declare passwords as string/octets with encrypt flag
+      if (kinds_[type] == Kind::ENCRYPTED || kinds_[type] == Kind::CHAP_PASSWORD)
+      {
+        continue;
+      }
+
+      const auto typeName = dictionaries.find_attribute_type(static_cast<uint8_t>(type));
+      if (typeName.has_value())
+      {
+        const auto kind = kindByTypeName(std::string(*typeName));
+        if (kind.has_value())
+        {
+          kinds_[type] = *kind;
+        }
+      }
+    }
+  }
+
+  const AttributeDecodeTable&
+  AttributeDecodeTable::standard()
+  {
+    static constexpr AttributeDecodeTable table;
+    return table;
+  }
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "attribute_index.h"
+
+namespace radius_lite
+{
+  namespace
+  {
+    bool vendor_entry_less(const AttributeIndex::VendorEntry& left, const AttributeIndex::VendorEntry& right)
+    {
+      if (left.vendor_id != right.vendor_id)
+      {
+        return left.vendor_id < right.vendor_id;
+      }
+
+      if (left.vendor_type != right.vendor_type)
+      {
+        return left.vendor_type < right.vendor_type;
+      }
+
+      return left.position < right.position;
+    }
+  }
+
+  AttributeIndex::AttributeIndex(std::pmr::memory_resource* resource)
+    : next_(resource),
+      vendor_(resource)
+  {
+    first_.fill(npos);
+  }
+
+  void AttributeIndex::build(
+    const std::vector<AttributeHolder>& attributes,
+    const std::vector<VendorSpecific>& vendorSpecific)
+  {
+    first_.fill(npos);
+    next_.assign(attributes.size(), npos);
+
+    // walk backward, so each attribute links to the following one with the same type
+    for (size_t position = attributes.size(); position-- > 0; )
+    {
+      if (!attributes[position])
+      {
+        continue;
+      }
+
+      const uint8_t type = attributes[position]->type();
+      next_[position] = first_[type];
+      first_[type] = static_cast<uint16_t>(position);
+    }
+
+    vendor_.clear();
+    vendor_.reserve(vendorSpecific.size());
+
+    for (size_t position = 0; position < vendorSpecific.size(); ++position)
+    {
+      vendor_.push_back(VendorEntry{
+        vendorSpecific[position].vendorId(),
+        vendorSpecific[position].vendorType(),
+        static_cast<uint16_t>(position)});
+    }
+
+    std::sort(vendor_.begin(), vendor_.end(), vendor_entry_less);
+  }
+
+  AttributeIndex::VendorRange
+  AttributeIndex::vendor(uint32_t vendor_id, uint8_t vendor_type) const
+  {
+    const VendorEntry lower{vendor_id, vendor_type, 0};
+    const VendorEntry upper{vendor_id, vendor_type, static_cast<uint16_t>(npos)};
+
+    auto begin = std::lower_bound(vendor_.begin(), vendor_.end(), lower, vendor_entry_less);
+    auto end = std::upper_bound(begin, vendor_.end(), upper, vendor_entry_less);
+    return VendorRange(vendor_.data() + (begin - vendor_.begin()), vendor_.data() + (end - vendor_.begin()));
+  }
+}
@@ -1,16 +1,31 @@
 #include <vector>
 #include <utility>
-#include <fstream>
-#include <iostream>
+#include <stdexcept>
 
-#include <boost/tokenizer.hpp>
 #include <boost/functional/hash.hpp>
 
 #include "dictionaries.h"
+#include "dictionary_parser.h"
 #include "error.h"
 
 namespace radius_lite
 {
+  AttributeValueType attributeValueType(const std::string& typeName)
+  {
+    static const std::unordered_map<std::string, AttributeValueType> types = {
+      {"string", AttributeValueType::STRING},
+      {"ipaddr", AttributeValueType::IPADDR},
+      {"byte", AttributeValueType::BYTE},
+      {"uint16", AttributeValueType::UINT16},
+      {"integer", AttributeValueType::INTEGER},
+      {"uint32", AttributeValueType::UINT32},
+      {"uint64", AttributeValueType::UINT64}
+    };
+
+    auto it = types.find(typeName);
+    return it != types.end() ? it->second : AttributeValueType::OCTETS;
+  }
+
   std::size_t radius_lite::Dictionaries::AttributeKeyHash::operator()(const AttributeKey& attribute_key) const
   {
     std::size_t seed = 0;
@@ -39,18 +54,64 @@ namespace radius_lite
     return reverse_dict_.at(name);
   }
 
-  void BasicDictionary::add(uint32_t code, const std::string& name)
+  std::optional<std::string_view> BasicDictionary::find_name(uint32_t code) const
   {
+    auto it = right_dict_.find(code);
+    if (it == right_dict_.end())
+    {
+      return std::nullopt;
+    }
+
+    return std::string_view(it->second);
+  }
+
+  std::optional<uint32_t> BasicDictionary::find_code(std::string_view name) const
+  {
+    auto it = reverse_dict_.find(name);
+    if (it == reverse_dict_.end())
+    {
+      return std::nullopt;
+    }
+
+    return it->second;
+  }
+
+  std::optional<uint32_t> BasicDictionary::find_code_(const std::string& name) const
+  {
+    auto it = reverse_dict_.find(name);
+    if (it == reverse_dict_.end())
+    {
+      return std::nullopt;
+    }
+
+    auto right_it = right_dict_.find(it->second);
+    if (right_it != right_dict_.end() && right_it->second == name)
+    {
+      return it->second;
+    }
+
+    // reverse index keeps the first code of the name, the code was renamed since
     for (const auto& entry: right_dict_)
     {
-      if (entry.second == name && entry.first != code)
+      if (entry.second == name)
       {
-        throw Exception(
-          Error::suchAttributeNameAlreadyExists,
-          "[BasicDictionary::add]. Attribute name " + name + " already exists with code " + std::to_string(entry.first));
+        return entry.first;
       }
     }
 
+    return std::nullopt;
+  }
+
+  void BasicDictionary::add(uint32_t code, const std::string& name)
+  {
+    const auto existing_code = find_code_(name);
+    if (existing_code && *existing_code != code)
+    {
+      throw Exception(
+        Error::suchAttributeNameAlreadyExists,
+        "[BasicDictionary::add]. Attribute name " + name + " already exists with code " + std::to_string(*existing_code));
+    }
+
     right_dict_.insert_or_assign(code, name);
     reverse_dict_.emplace(name, code);
   }
@@ -59,15 +120,13 @@ namespace radius_lite
   {
     for (const auto& entry: basicDict.right_dict_)
     {
-      for (const auto& item: right_dict_)
+      const auto existing_code = find_code_(entry.second);
+      if (existing_code && *existing_code != entry.first)
       {
-        if (entry.second == item.second && entry.first != item.first)
-        {
-          throw Exception(
-            Error::suchAttributeNameAlreadyExists,
-            "[BasicDictionary::append]. Attribute name " + entry.second + " already exists with code " +
-            std::to_string(item.first));
-        }
+        throw Exception(
+          Error::suchAttributeNameAlreadyExists,
+          "[BasicDictionary::append]. Attribute name " + entry.second + " already exists with code " +
+          std::to_string(*existing_code));
       }
 
       right_dict_.insert_or_assign(entry.first, entry.second);
@@ -79,6 +138,30 @@ namespace radius_lite
     }
   }
 
+  // nodes are moved from basicDict, it is left in unspecified state
+  void BasicDictionary::append(BasicDictionary&& basicDict)
+  {
+    for (auto it = basicDict.right_dict_.begin(); it != basicDict.right_dict_.end();)
+    {
+      const auto existing_code = find_code_(it->second);
+      if (existing_code && *existing_code != it->first)
+      {
+        throw Exception(
+          Error::suchAttributeNameAlreadyExists,
+          "[BasicDictionary::append]. Attribute name " + it->second + " already exists with code " +
+          std::to_string(*existing_code));
+      }
+
+      auto result = right_dict_.insert(basicDict.right_dict_.extract(it++));
+      if (!result.inserted)
+      {
+        result.position->second = std::move(result.node.mapped());
+      }
+    }
+
+    reverse_dict_.merge(basicDict.reverse_dict_);
+  }
+
   // DependentDictionary impl
   std::string DependentDictionary::name(const std::string& dependencyName, uint32_t code) const
   {
@@ -90,19 +173,71 @@ namespace radius_lite
     return reverse_dict_.at(std::make_pair(dependencyName, name));
   }
 
-  void DependentDictionary::add(uint32_t code, const std::string& name, const std::string& dependencyName)
+  std::optional<std::string_view>
+  DependentDictionary::find_name(const std::string& dependencyName, uint32_t code) const
   {
-    for (const auto& entry: right_dict_)
+    auto it = right_dict_.find(std::make_pair(dependencyName, code));
+    if (it == right_dict_.end())
     {
-      if (entry.second == name && entry.first.first == dependencyName && entry.first.second != code)
+      return std::nullopt;
+    }
+
+    return std::string_view(it->second);
+  }
+
+  std::optional<uint32_t>
+  DependentDictionary::find_code(std::string_view dependencyName, std::string_view name) const
+  {
+    auto it = reverse_dict_.find(std::make_pair(dependencyName, name));
+    if (it == reverse_dict_.end())
+    {
+      return std::nullopt;
+    }
+
+    return it->second;
+  }
+
+  std::optional<uint32_t>
+  DependentDictionary::find_code_(const std::string& dependencyName, const std::string& name) const
+  {
+    auto it = reverse_dict_.find(std::make_pair(dependencyName, name));
+    if (it == reverse_dict_.end())
+    {
+      return std::nullopt;
+    }
+
+    auto right_it = right_dict_.find(std::make_pair(dependencyName, it->second));
+    if (right_it != right_dict_.end() && right_it->second == name)
+    {
+      return it->second;
+    }
+
+    // reverse index keeps the first code of the name, the code was renamed since,
+    // codes of one dependency are adjacent in right_dict_
+    for (auto entry = right_dict_.lower_bound(std::make_pair(dependencyName, uint32_t(0)));
+      entry != right_dict_.end() && entry->first.first == dependencyName;
+      ++entry)
+    {
+      if (entry->second == name)
       {
-        throw Exception(
-          Error::suchAttributeNameAlreadyExists,
-          "[DependentDictionary::add]. Value name " + name + " of attribute " + dependencyName +
-          " already exists with code " + std::to_string(entry.first.second));
+        return entry->first.second;
       }
     }
 
+    return std::nullopt;
+  }
+
+  void DependentDictionary::add(uint32_t code, const std::string& name, const std::string& dependencyName)
+  {
+    const auto existing_code = find_code_(dependencyName, name);
+    if (existing_code && *existing_code != code)
+    {
+      throw Exception(
+        Error::suchAttributeNameAlreadyExists,
+        "[DependentDictionary::add]. Value name " + name + " of attribute " + dependencyName +
+        " already exists with code " + std::to_string(*existing_code));
+    }
+
     right_dict_.insert_or_assign(std::make_pair(dependencyName, code), name);
     reverse_dict_.emplace(std::make_pair(dependencyName, name), code);
   }
@@ -111,17 +246,14 @@ namespace radius_lite
   {
     for (const auto& entry: dependentDict.right_dict_)
     {
-      for (const auto& item: right_dict_)
+      const auto existing_code = find_code_(entry.first.first, entry.second);
+      if (existing_code && *existing_code != entry.first.second)
       {
-        if (item.second == entry.second && item.first.first == entry.first.first &&
-          item.first.second != entry.first.second)
-        {
-          throw Exception(Error::suchAttributeNameAlreadyExists,
-            "[DependentDictionary::append]. Value name " + entry.second + " of attribute " +
-            entry.first.first +
-            "(code = " + std::to_string(entry.first.second) + ") already exists with code " +
-            std::to_string(item.first.second));
-        }
+        throw Exception(Error::suchAttributeNameAlreadyExists,
+          "[DependentDictionary::append]. Value name " + entry.second + " of attribute " +
+          entry.first.first +
+          "(code = " + std::to_string(entry.first.second) + ") already exists with code " +
+          std::to_string(*existing_code));
       }
 
       right_dict_.insert_or_assign(std::make_pair(entry.first.first, entry.first.second), entry.second);
@@ -133,116 +265,132 @@ namespace radius_lite
     }
   }
 
-  // Dictionaries impl
-  Dictionaries::Dictionaries(const std::string& filePath)
+  // nodes are moved from dependentDict, it is left in unspecified state
+  void DependentDictionary::append(DependentDictionary&& dependentDict)
   {
-    std::ifstream stream(filePath);
-    if (!stream)
+    for (auto it = dependentDict.right_dict_.begin(); it != dependentDict.right_dict_.end();)
     {
-      throw std::runtime_error("Cannot open dictionary file " + filePath);
+      const auto existing_code = find_code_(it->first.first, it->second);
+      if (existing_code && *existing_code != it->first.second)
+      {
+        throw Exception(Error::suchAttributeNameAlreadyExists,
+          "[DependentDictionary::append]. Value name " + it->second + " of attribute " +
+          it->first.first +
+          "(code = " + std::to_string(it->first.second) + ") already exists with code " +
+          std::to_string(*existing_code));
+      }
+
+      auto result = right_dict_.insert(dependentDict.right_dict_.extract(it++));
+      if (!result.inserted)
+      {
+        result.position->second = std::move(result.node.mapped());
+      }
     }
 
-    using tokenizer = boost::tokenizer<boost::char_separator<char>>;
-    boost::char_separator<char> sep(" \t");
+    for (auto it = dependentDict.reverse_dict_.begin(); it != dependentDict.reverse_dict_.end();)
+    {
+      auto result = reverse_dict_.insert(dependentDict.reverse_dict_.extract(it++));
+      if (!result.inserted)
+      {
+        result.position->second = result.node.mapped();
+      }
+    }
+  }
+
+  // Dictionaries impl
+  Dictionaries::Dictionaries(const std::string& filePath)
+  {
+    const auto files = parseDictionaryTree(filePath);
+    load_(files, 0);
+  }
+
+  // every file is loaded into its own Dictionaries and appended at its $INCLUDE line
+  void Dictionaries::load_(const std::vector<DictionaryFile>& files, size_t index)
+  {
+    const DictionaryFile& file = files[index];
+    source_files_.push_back(file.path);
 
-    std::string line;
     std::string vendorName;
+    size_t include = 0;
 
-    while (std::getline(stream, line))
+    for (const auto& line : file.lines)
     {
-      tokenizer tok(line, sep);
-
-      std::vector<std::string> tokens;
-      std::copy(tok.begin(), tok.end(), std::back_inserter(tokens));
+      const auto& tokens = line.tokens;
 
-      if (!tokens.empty())
+      switch (line.keyword)
       {
-        if (tokens[0] == "ATTRIBUTE")
+        case DictionaryLine::Keyword::ATTRIBUTE:
         {
-          const auto& attrName = tokens[1];
-          const auto& attrId = tokens[2];
+          const std::string attrName(tokens[0]);
+          const auto& attrId = tokens[1];
 
-          if (attrId.find('.') == std::string::npos) // skip attrbutes with OID
+          if (attrId.find('.') != std::string_view::npos) // skip attrbutes with OID
           {
-            const auto code = std::stoul(tokens[2]);
-            std::string attrTypeName = tokens[3];
-
-            auto size_part_pos = attrTypeName.find('[');
-            if (size_part_pos != std::string::npos)
-            {
-              attrTypeName = attrTypeName.substr(0, size_part_pos);
-            }
-
-            if (!vendorName.empty())
-            {
-              m_vendorAttributes.add(code, attrName, vendorName);
-            }
-            else
-            {
-              m_attributes.add(code, attrName);
-            }
-
-            bool resolved = true;
-            uint32_t vendor_id = 0;
-            if (!vendorName.empty())
-            {
-              try
-              {
-                vendor_id = m_vendorNames.code(vendorName);
-              }
-              catch(const std::exception&)
-              {
-                resolved = false;
-              }
-            }
-
-            if (resolved)
-            {
-              m_attributeTypes.emplace(AttributeKey(code, vendor_id), attrTypeName);
-            }
-            else
-            {
-              m_unresolvedAttributeTypes.emplace(
-                UnresolvedAttributeKey(code, vendorName), attrTypeName);
-            }
+            break;
           }
-        }
-        else if (tokens[0] == "VALUE")
-        {
-          const auto& attrNameVal = tokens[1];
-          const auto& valueName = tokens[2];
-          const auto valueCode = std::stoul(tokens[3]);
+
+          if (tokens[2].empty())
+          {
+            throw std::runtime_error("Invalid ATTRIBUTE line in dictionary file " + file.path);
+          }
+
+          const auto code = parseDictionaryCode(attrId);
+          std::string attrTypeName(tokens[2].substr(0, tokens[2].find('[')));
+
           if (!vendorName.empty())
           {
-            vendor_attribute_values_.add(valueCode, valueName, attrNameVal);
+            m_vendorAttributes.add(code, attrName, vendorName);
           }
           else
           {
-            m_attributeValues.add(valueCode, valueName, attrNameVal);
+            m_attributes.add(code, attrName);
           }
+
+          const auto vendor_id = vendorName.empty() ? std::optional<uint32_t>(0) : m_vendorNames.find_code(vendorName);
+
+          if (vendor_id)
+          {
+            add_attribute_type_(AttributeKey(code, *vendor_id), attrTypeName);
+          }
+          else
+          {
+            m_unresolvedAttributeTypes.emplace(
+              UnresolvedAttributeKey(code, vendorName), std::move(attrTypeName));
+          }
+
+          break;
         }
-        else if (tokens[0] == "VENDOR")
-        {
-          m_vendorNames.add(std::stoul(tokens[2]), tokens[1]);
-        }
-        else if (tokens[0] == "BEGIN-VENDOR")
-        {
-          vendorName = tokens[1];
-        }
-        else if (tokens[0] == "END-VENDOR")
-        {
-          vendorName.clear();
-        }
-        else if (tokens[0] == "$INCLUDE")
+        case DictionaryLine::Keyword::VALUE:
         {
-          if (tokens[1].substr(0, 1) == "/")
+          const std::string attrNameVal(tokens[0]);
+          const std::string valueName(tokens[1]);
+          const auto valueCode = parseDictionaryCode(tokens[2]);
+          if (!vendorName.empty())
           {
-            append(Dictionaries(tokens[1]));
+            vendor_attribute_values_.add(valueCode, valueName, attrNameVal);
           }
           else
           {
-            append(Dictionaries(filePath.substr(0, filePath.rfind('/') + 1) + tokens[1]));
+            m_attributeValues.add(valueCode, valueName, attrNameVal);
           }
+
+          break;
+        }
+        case DictionaryLine::Keyword::VENDOR:
+          m_vendorNames.add(parseDictionaryCode(tokens[1]), std::string(tokens[0]));
+          break;
+        case DictionaryLine::Keyword::BEGIN_VENDOR:
+          vendorName = tokens[0];
+          break;
+        case DictionaryLine::Keyword::END_VENDOR:
+          vendorName.clear();
+          break;
+        case DictionaryLine::Keyword::INCLUDE:
+        {
+          Dictionaries included;
+          included.load_(files, file.includes[include++]);
+          append(std::move(included));
+          break;
         }
       }
     }
@@ -255,12 +403,37 @@ namespace radius_lite
     m_attributeValues.append(fillingDictionaries.m_attributeValues);
     m_vendorAttributes.append(fillingDictionaries.m_vendorAttributes);
     vendor_attribute_values_.append(fillingDictionaries.vendor_attribute_values_);
-    m_attributeTypes.insert(
-      fillingDictionaries.m_attributeTypes.begin(),
-      fillingDictionaries.m_attributeTypes.end());
+    for (const auto& [attribute_key, attribute_type] : fillingDictionaries.m_attributeTypes)
+    {
+      add_attribute_type_(attribute_key, attribute_type);
+    }
+
     m_unresolvedAttributeTypes.insert(
       fillingDictionaries.m_unresolvedAttributeTypes.begin(),
       fillingDictionaries.m_unresolvedAttributeTypes.end());
+    source_files_.insert(
+      source_files_.end(),
+      fillingDictionaries.source_files_.begin(),
+      fillingDictionaries.source_files_.end());
+  }
+
+  void Dictionaries::append(Dictionaries&& fillingDictionaries)
+  {
+    m_attributes.append(std::move(fillingDictionaries.m_attributes));
+    m_vendorNames.append(std::move(fillingDictionaries.m_vendorNames));
+    m_attributeValues.append(std::move(fillingDictionaries.m_attributeValues));
+    m_vendorAttributes.append(std::move(fillingDictionaries.m_vendorAttributes));
+    vendor_attribute_values_.append(std::move(fillingDictionaries.vendor_attribute_values_));
+    for (const auto& [attribute_key, attribute_type] : fillingDictionaries.m_attributeTypes)
+    {
+      add_attribute_type_(attribute_key, attribute_type);
+    }
+
+    m_unresolvedAttributeTypes.merge(fillingDictionaries.m_unresolvedAttributeTypes);
+    source_files_.insert(
+      source_files_.end(),
+      std::make_move_iterator(fillingDictionaries.source_files_.begin()),
+      std::make_move_iterator(fillingDictionaries.source_files_.end()));
   }
 
   std::string Dictionaries::attributeName(uint32_t code) const
@@ -320,6 +493,62 @@ namespace radius_lite
     return vendorAttributeValues().code(valueName, name);
   }
 
+  std::optional<std::string_view> Dictionaries::find_attribute_name(uint32_t code) const
+  {
+    return attributes().find_name(code);
+  }
+
+  std::optional<uint32_t> Dictionaries::find_attribute_code(std::string_view name) const
+  {
+    return attributes().find_code(name);
+  }
+
+  std::optional<std::string_view> Dictionaries::find_vendor_name(uint32_t code) const
+  {
+    return vendorNames().find_name(code);
+  }
+
+  std::optional<uint32_t> Dictionaries::find_vendor_code(const std::string& name) const
+  {
+    return vendorNames().find_code(name);
+  }
+
+  std::optional<std::string_view>
+  Dictionaries::find_vendor_attribute_name(const std::string& vendorName, uint32_t code) const
+  {
+    return vendorAttributes().find_name(vendorName, code);
+  }
+
+  std::optional<uint32_t>
+  Dictionaries::find_vendor_attribute_code(const std::string& vendorName, const std::string& name) const
+  {
+    return vendorAttributes().find_code(vendorName, name);
+  }
+
+  std::optional<std::string_view>
+  Dictionaries::find_attribute_value_name(const std::string& attributeName, uint32_t code) const
+  {
+    return attributeValues().find_name(attributeName, code);
+  }
+
+  std::optional<uint32_t>
+  Dictionaries::find_attribute_value_code(const std::string& attributeName, const std::string& name) const
+  {
+    return attributeValues().find_code(attributeName, name);
+  }
+
+  std::optional<std::string_view>
+  Dictionaries::find_vendor_attribute_value_name(const std::string& valueName, uint32_t code) const
+  {
+    return vendorAttributeValues().find_name(valueName, code);
+  }
+
+  std::optional<uint32_t>
+  Dictionaries::find_vendor_attribute_value_code(const std::string& valueName, const std::string& name) const
+  {
+    return vendorAttributeValues().find_code(valueName, name);
+  }
+
   std::optional<std::string>
   Dictionaries::get_attribute_type(uint8_t code, uint32_t vendor_id) const
   {
@@ -332,21 +561,36 @@ namespace radius_lite
     return std::nullopt;
   }
 
+  std::optional<std::string_view>
+  Dictionaries::find_attribute_type(uint8_t code, uint32_t vendor_id) const
+  {
+    auto it = m_attributeTypes.find(AttributeKey(code, vendor_id));
+    if (it != m_attributeTypes.end())
+    {
+      return std::string_view(it->second);
+    }
+
+    return std::nullopt;
+  }
+
   std::optional<Dictionaries::AttributeKey>
   Dictionaries::get_attribute_key(
-    const std::string& attribute_name,
-    const std::string& vendor_name) const
+    std::string_view attribute_name,
+    std::string_view vendor_name) const
   {
-    try
+    const auto vendor_id = vendorNames().find_code(vendor_name);
+    if (!vendor_id)
     {
-      auto vendor_id = vendorNames().code(vendor_name);
-      auto code = vendorAttributeCode(vendor_name, attribute_name);
-      return AttributeKey(code, vendor_id);
+      return std::nullopt;
     }
-    catch (const std::exception&)
-    {}
 
-    return std::nullopt;
+    const auto code = vendorAttributes().find_code(vendor_name, attribute_name);
+    if (!code)
+    {
+      return std::nullopt;
+    }
+
+    return AttributeKey(static_cast<uint8_t>(*code), *vendor_id);
   }
 
   void
@@ -354,7 +598,7 @@ namespace radius_lite
   {
     for (const auto& [unresolved_attr_key, attribute_type] : m_unresolvedAttributeTypes)
     {
-      m_attributeTypes.emplace(
+      add_attribute_type_(
         AttributeKey(
           unresolved_attr_key.code,
           m_vendorNames.code(unresolved_attr_key.vendor_name)),
@@ -363,4 +607,22 @@ namespace radius_lite
 
     m_unresolvedAttributeTypes.clear();
   }
+
+  void
+  Dictionaries::add_attribute_type_(const AttributeKey& attribute_key, const std::string& typeName)
+  {
+    if (!m_attributeTypes.emplace(attribute_key, typeName).second)
+    {
+      return;
+    }
+
+    if (attribute_key.vendor_id == 0)
+    {
+      value_types_[attribute_key.code] = attributeValueType(typeName);
+    }
+    else
+    {
+      vendor_value_types_.emplace(attribute_key, attributeValueType(typeName));
+    }
+  }
 }
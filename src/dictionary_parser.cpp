@@ -0,0 +1,363 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "dictionary_parser.h"
+
+namespace radius_lite
+{
+  namespace
+  {
+    struct Keyword
+    {
+      std::string_view name;
+      DictionaryLine::Keyword keyword;
+      // tokens required after the keyword
+      size_t tokens;
+    };
+
+    const std::array<Keyword, 6> KEYWORDS {{
+      {"ATTRIBUTE", DictionaryLine::Keyword::ATTRIBUTE, 2},
+      {"VALUE", DictionaryLine::Keyword::VALUE, 3},
+      {"VENDOR", DictionaryLine::Keyword::VENDOR, 2},
+      {"BEGIN-VENDOR", DictionaryLine::Keyword::BEGIN_VENDOR, 1},
+      {"END-VENDOR", DictionaryLine::Keyword::END_VENDOR, 0},
+      {"$INCLUDE", DictionaryLine::Keyword::INCLUDE, 1}
+    }};
+
+    bool isSeparator(char c)
+    {
+      return c == ' ' || c == '\t';
+    }
+
+    std::shared_ptr<const char> mapFile(const std::string& path, size_t& size)
+    {
+      const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+      {
+        throw std::runtime_error("Cannot open dictionary file " + path);
+      }
+
+      struct stat file_stat{};
+      if (::fstat(fd, &file_stat) != 0)
+      {
+        ::close(fd);
+        throw std::runtime_error("Cannot open dictionary file " + path);
+      }
+
+      size = static_cast<size_t>(file_stat.st_size);
+      if (size == 0)
+      {
+        ::close(fd);
+        return std::shared_ptr<const char>();
+      }
+
+      void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+
+      if (mapping == MAP_FAILED)
+      {
+        throw std::runtime_error("Cannot map dictionary file " + path);
+      }
+
+      const size_t mapped_size = size;
+      return std::shared_ptr<const char>(
+        static_cast<const char*>(mapping),
+        [mapped_size](const char* data) { ::munmap(const_cast<char*>(data), mapped_size); });
+    }
+
+    // separated by spaces and tabs like boost::char_separator(" \t") of the previous parser
+    void parseLine(DictionaryFile& file, std::string_view line)
+    {
+      std::array<std::string_view, 4> tokens;
+      size_t count = 0;
+      size_t pos = 0;
+
+      while (count < tokens.size())
+      {
+        while (pos < line.size() && isSeparator(line[pos]))
+        {
+          ++pos;
+        }
+
+        if (pos == line.size())
+        {
+          break;
+        }
+
+        const size_t start = pos;
+        while (pos < line.size() && !isSeparator(line[pos]))
+        {
+          ++pos;
+        }
+
+        tokens[count++] = line.substr(start, pos - start);
+      }
+
+      if (count == 0)
+      {
+        return;
+      }
+
+      for (const auto& keyword : KEYWORDS)
+      {
+        if (tokens[0] == keyword.name)
+        {
+          if (count <= keyword.tokens)
+          {
+            throw std::runtime_error(
+              "Invalid " + std::string(keyword.name) + " line in dictionary file " + file.path);
+          }
+
+          file.lines.push_back(DictionaryLine{keyword.keyword, {tokens[1], tokens[2], tokens[3]}});
+          return;
+        }
+      }
+    }
+
+    void parseFile(DictionaryFile& file)
+    {
+      size_t size = 0;
+      file.data = mapFile(file.path, size);
+
+      const std::string_view text(file.data.get(), size);
+      size_t pos = 0;
+
+      while (pos < text.size())
+      {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+        {
+          end = text.size();
+        }
+
+        parseLine(file, text.substr(pos, end - pos));
+        pos = end + 1;
+      }
+    }
+
+    std::string includePath(const std::string& file_path, std::string_view include)
+    {
+      if (include.substr(0, 1) == "/")
+      {
+        return std::string(include);
+      }
+
+      return file_path.substr(0, file_path.rfind('/') + 1) + std::string(include);
+    }
+
+    // parse threads of the process, besides the calling thread
+    const unsigned MAX_PARSE_THREADS = 8;
+
+    // Workers are created on the first parse of more than one file and reused by later
+    // parses (reloads, image rebuilds); the caller parses too, so a busy pool only slows it down.
+    class ParsePool
+    {
+    public:
+      static ParsePool& instance()
+      {
+        static ParsePool pool;
+        return pool;
+      }
+
+      ~ParsePool()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto& thread : threads_)
+        {
+          thread.join();
+        }
+      }
+
+      size_t size() const
+      {
+        return threads_.size();
+      }
+
+      void post(std::function<void()> task)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          tasks_.push_back(std::move(task));
+        }
+        wake_.notify_one();
+      }
+
+    private:
+      ParsePool()
+        : stopping_(false)
+      {
+        const unsigned threads_count = std::min(std::max(1u, std::thread::hardware_concurrency()), MAX_PARSE_THREADS);
+
+        for (unsigned i = 1; i < threads_count; ++i)
+        {
+          threads_.emplace_back([this]() { run_(); });
+        }
+      }
+
+      void run_()
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (true)
+        {
+          wake_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+          if (tasks_.empty())
+          {
+            return;
+          }
+
+          auto task = std::move(tasks_.front());
+          tasks_.pop_front();
+          lock.unlock();
+          task();
+          lock.lock();
+        }
+      }
+
+    private:
+      std::mutex mutex_;
+      std::condition_variable wake_;
+      std::deque<std::function<void()>> tasks_;
+      bool stopping_;
+      std::vector<std::thread> threads_;
+    };
+
+    // workers take files by index, errors are rethrown in file order;
+    // a single file is parsed inline
+    void parseFiles(std::vector<DictionaryFile>& files, size_t begin, size_t end)
+    {
+      const size_t count = end - begin;
+      std::vector<std::exception_ptr> errors(count);
+      std::atomic<size_t> next(0);
+
+      auto work = [&files, &errors, &next, begin, count]()
+      {
+        for (size_t i = next++; i < count; i = next++)
+        {
+          try
+          {
+            parseFile(files[begin + i]);
+          }
+          catch (...)
+          {
+            errors[i] = std::current_exception();
+          }
+        }
+      };
+
+      const size_t helpers_count = count > 1 ? std::min(count - 1, ParsePool::instance().size()) : 0;
+
+      // helpers reference this frame, it is left after all of them finished
+      std::mutex mutex;
+      std::condition_variable finished;
+      size_t running = helpers_count;
+
+      for (size_t i = 0; i < helpers_count; ++i)
+      {
+        ParsePool::instance().post(
+          [&work, &mutex, &finished, &running]()
+          {
+            work();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0)
+            {
+              finished.notify_one();
+            }
+          });
+      }
+
+      work();
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&running]() { return running == 0; });
+      }
+
+      for (const auto& error : errors)
+      {
+        if (error)
+        {
+          std::rethrow_exception(error);
+        }
+      }
+    }
+  }
+
+  std::vector<DictionaryFile> parseDictionaryTree(const std::string& file_path)
+  {
+    std::vector<DictionaryFile> files(1);
+    files[0].path = file_path;
+
+    size_t level_begin = 0;
+    size_t level_end = 1;
+
+    while (level_begin < level_end)
+    {
+      parseFiles(files, level_begin, level_end);
+
+      std::vector<std::string> included_paths;
+
+      for (size_t i = level_begin; i < level_end; ++i)
+      {
+        for (const auto& line : files[i].lines)
+        {
+          if (line.keyword == DictionaryLine::Keyword::INCLUDE)
+          {
+            files[i].includes.push_back(level_end + included_paths.size());
+            included_paths.push_back(includePath(files[i].path, line.tokens[0]));
+          }
+        }
+      }
+
+      files.resize(level_end + included_paths.size());
+
+      for (size_t i = 0; i < included_paths.size(); ++i)
+      {
+        files[level_end + i].path = std::move(included_paths[i]);
+      }
+
+      level_begin = level_end;
+      level_end = files.size();
+    }
+
+    return files;
+  }
+
+  uint32_t parseDictionaryCode(std::string_view token)
+  {
+    unsigned long code = 0;
+    const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), code);
+
+    if (ec == std::errc::invalid_argument)
+    {
+      throw std::invalid_argument("Invalid dictionary code " + std::string(token));
+    }
+
+    if (ec == std::errc::result_out_of_range)
+    {
+      throw std::out_of_range("Invalid dictionary code " + std::string(token));
+    }
+
+    return static_cast<uint32_t>(code);
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint> //uint8_t, uint32_t
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace radius_lite
+{
+  // keyword line of a dictionary file, tokens point into the mapped file
+  struct DictionaryLine
+  {
+    enum class Keyword : uint8_t
+    {
+      ATTRIBUTE,
+      VALUE,
+      VENDOR,
+      BEGIN_VENDOR,
+      END_VENDOR,
+      INCLUDE
+    };
+
+    Keyword keyword;
+    // tokens after the keyword, unused are empty
+    std::array<std::string_view, 3> tokens;
+  };
+
+  struct DictionaryFile
+  {
+    std::string path;
+    // read-only mapping of the file that keeps token views valid
+    std::shared_ptr<const char> data;
+    std::vector<DictionaryLine> lines;
+    // index of the file of each INCLUDE line in the parsed tree, in line order
+    std::vector<size_t> includes;
+  };
+
+  // Maps file_path and every file it includes and splits them into lines without copying.
+  // Files of one include level are parsed in parallel on a process-wide pool of threads. The root file has index 0,
+  // throws std::runtime_error if a file can't be opened or a keyword line lacks tokens.
+  std::vector<DictionaryFile> parseDictionaryTree(const std::string& file_path);
+
+  // decimal code as read by std::stoul, throws std::invalid_argument without digits
+  uint32_t parseDictionaryCode(std::string_view token);
+}
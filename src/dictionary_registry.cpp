@@ -0,0 +1,72 @@
+#include "dictionary_registry.h"
+#include "frozen_dictionaries.h"
+
+namespace radius_lite
+{
+  namespace
+  {
+    std::shared_ptr<const DictionaryLookup>
+    loadDictionaries(const std::string& file_path, const std::string& image_path)
+    {
+      if (!image_path.empty())
+      {
+        return std::make_shared<FrozenDictionaries>(FrozenDictionaries::open(file_path, image_path));
+      }
+
+      auto dictionaries = std::make_shared<Dictionaries>(file_path);
+      dictionaries->resolve();
+      return dictionaries;
+    }
+  }
+
+  DictionaryRegistry::Reader::Reader(const DictionaryRegistry& registry)
+    : registry_(registry),
+      version_(registry.version()),
+      snapshot_(registry.snapshot())
+  {}
+
+  bool DictionaryRegistry::Reader::update()
+  {
+    const uint64_t version = registry_.version();
+
+    if (version == version_)
+    {
+      return false;
+    }
+
+    // snapshot is stored before the version is incremented, so it is at least this version
+    version_ = version;
+    auto snapshot = registry_.snapshot();
+    const bool changed = snapshot != snapshot_;
+    snapshot_ = std::move(snapshot);
+    return changed;
+  }
+
+  DictionaryRegistry::DictionaryRegistry(std::string file_path, std::string image_path)
+    : file_path_(std::move(file_path)),
+      image_path_(std::move(image_path)),
+      current_(loadDictionaries(file_path_, image_path_)),
+      version_(0)
+  {}
+
+  DictionaryRegistry::DictionaryRegistry(std::shared_ptr<const DictionaryLookup> dictionaries)
+    : current_(std::move(dictionaries)),
+      version_(0)
+  {}
+
+  std::shared_ptr<const DictionaryLookup> DictionaryRegistry::snapshot() const
+  {
+    return std::atomic_load(&current_);
+  }
+
+  void DictionaryRegistry::publish(std::shared_ptr<const DictionaryLookup> dictionaries)
+  {
+    std::atomic_store(&current_, std::move(dictionaries));
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  void DictionaryRegistry::reload()
+  {
+    publish(loadDictionaries(file_path_, image_path_));
+  }
+}
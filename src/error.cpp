@@ -43,6 +43,10 @@ std::string ErrorCategory::message(int ev) const noexcept
             return "Such attribute name already exists";
         case Error::suchAttributeCodeAlreadyExists:
             return "Such attribute code already exists";
+        case Error::sendBufferIsTooSmall:
+            return "Send buffer is too small for the packet";
+        case Error::invalidMessageAuthenticator:
+            return "Message-Authenticator doesn't match the packet";
        default:
             return "(Unrecognized error)";
     }
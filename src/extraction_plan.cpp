@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <tuple>
+#include <stdexcept>
+
+#include "extraction_plan.h"
+#include "utils.h"
+
+namespace radius_lite
+{
+  namespace
+  {
+    bool isInteger(AttributeValueType type)
+    {
+      return type == AttributeValueType::BYTE ||
+        type == AttributeValueType::UINT16 ||
+        type == AttributeValueType::INTEGER ||
+        type == AttributeValueType::UINT32 ||
+        type == AttributeValueType::UINT64;
+    }
+  }
+
+  ExtractionPlan::ExtractionPlan(const DictionaryLookup& dictionaries, const std::vector<Field>& fields)
+  {
+    slots_.fill(NO_SLOT);
+    types_.reserve(fields.size());
+
+    for (const auto& field : fields)
+    {
+      const uint16_t slot = static_cast<uint16_t>(types_.size());
+      std::optional<AttributeKey> key;
+
+      if (field.vendor_name.empty())
+      {
+        const auto code = dictionaries.find_attribute_code(field.name);
+        if (code && *code < slots_.size())
+        {
+          key = AttributeKey(static_cast<uint8_t>(*code));
+        }
+      }
+      else
+      {
+        key = dictionaries.get_attribute_key(field.name, field.vendor_name);
+      }
+
+      if (!key)
+      {
+        types_.push_back(AttributeValueType::NONE);
+        continue;
+      }
+
+      // attribute without type in dictionary is returned as octets
+      const auto type = dictionaries.get_attribute_value_type(key->code, key->vendor_id);
+      types_.push_back(type != AttributeValueType::NONE ? type : AttributeValueType::OCTETS);
+
+      if (key->vendor_id == 0)
+      {
+        if (slots_[key->code] == NO_SLOT)
+        {
+          slots_[key->code] = slot;
+        }
+        else
+        {
+          duplicates_.emplace_back(slots_[key->code], slot);
+        }
+      }
+      else
+      {
+        add_vendor_slot_(key->vendor_id, key->code, slot);
+      }
+    }
+  }
+
+  void
+  ExtractionPlan::add_vendor_slot_(uint32_t vendor_id, uint8_t vendor_type, uint16_t slot)
+  {
+    const uint16_t existing = vendor_slot_(vendor_id, vendor_type);
+    if (existing != NO_SLOT)
+    {
+      duplicates_.emplace_back(existing, slot);
+      return;
+    }
+
+    const VendorSlot entry{vendor_id, vendor_type, slot};
+    auto it = std::lower_bound(
+      vendor_slots_.begin(),
+      vendor_slots_.end(),
+      entry,
+      [](const VendorSlot& left, const VendorSlot& right)
+      {
+        return std::tie(left.vendor_id, left.vendor_type) < std::tie(right.vendor_id, right.vendor_type);
+      });
+
+    vendor_slots_.insert(it, entry);
+  }
+
+  uint16_t
+  ExtractionPlan::vendor_slot_(uint32_t vendor_id, uint8_t vendor_type) const
+  {
+    auto it = std::lower_bound(
+      vendor_slots_.begin(),
+      vendor_slots_.end(),
+      std::make_pair(vendor_id, vendor_type),
+      [](const VendorSlot& left, const std::pair<uint32_t, uint8_t>& right)
+      {
+        return std::tie(left.vendor_id, left.vendor_type) < std::tie(right.first, right.second);
+      });
+
+    if (it != vendor_slots_.end() && it->vendor_id == vendor_id && it->vendor_type == vendor_type)
+    {
+      return it->slot;
+    }
+
+    return NO_SLOT;
+  }
+
+  void
+  ExtractionPlan::extract(const Packet& packet, Value* values) const
+  {
+    std::fill(values, values + types_.size(), Value());
+
+    for (const auto& attribute : packet.attributes())
+    {
+      const uint16_t slot = slots_[attribute->type()];
+      if (slot == NO_SLOT || values[slot].present)
+      {
+        continue;
+      }
+
+      Value& value = values[slot];
+      const auto octets = attribute->value_view();
+
+      if (octets)
+      {
+        fill_(value, types_[slot], *octets);
+      }
+      else
+      {
+        // integers are kept decoded, CHAP-Password has no octets view:
+        // without wire bytes a value that doesn't fit the field type is reported as a mismatch
+        const auto integer = attribute->as_uint();
+        value.present = true;
+        value.integer = integer.value_or(0);
+        value.type = integer && isInteger(types_[slot]) ? types_[slot] : AttributeValueType::NONE;
+      }
+    }
+
+    if (!vendor_slots_.empty())
+    {
+      for (const auto& attribute : packet.vendorSpecific())
+      {
+        const uint16_t slot = vendor_slot_(attribute.vendorId(), attribute.vendorType());
+        if (slot != NO_SLOT && !values[slot].present)
+        {
+          fill_(values[slot], types_[slot], attribute.value());
+        }
+      }
+    }
+
+    for (const auto& [from, to] : duplicates_)
+    {
+      values[to] = values[from];
+    }
+  }
+
+  void
+  ExtractionPlan::fill_(Value& value, AttributeValueType type, const ByteSpan& octets) const
+  {
+    value.present = true;
+    value.type = type;
+
+    if (isInteger(type))
+    {
+      const auto integer = readUint(octets);
+      if (integer)
+      {
+        value.integer = *integer;
+        return;
+      }
+
+      value.type = AttributeValueType::OCTETS;
+    }
+    else if (type == AttributeValueType::IPADDR && octets.size() != 4)
+    {
+      value.type = AttributeValueType::OCTETS;
+    }
+
+    value.octets = octets;
+  }
+}
@@ -0,0 +1,642 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "frozen_dictionaries.h"
+
+namespace radius_lite
+{
+  namespace
+  {
+    const std::array<char, 8> IMAGE_MAGIC {'R', 'L', 'D', 'I', 'C', 'T', '\0', '\0'};
+    const uint32_t IMAGE_VERSION = 1;
+    const uint32_t IMAGE_BYTE_ORDER = 0x01020304;
+
+    size_t align8(size_t offset)
+    {
+      return (offset + 7) / 8 * 8;
+    }
+  }
+
+  // collects entries of every section and lays them out into one image
+  class FrozenDictionaries::Builder
+  {
+  public:
+    explicit Builder(const Dictionaries& dictionaries)
+    {
+      add_(ATTRIBUTE_NAMES, ATTRIBUTE_CODES, dictionaries.m_attributes);
+      add_(VENDOR_NAMES, VENDOR_CODES, dictionaries.m_vendorNames);
+      add_(ATTRIBUTE_VALUE_NAMES, ATTRIBUTE_VALUE_CODES, dictionaries.m_attributeValues);
+      add_(VENDOR_ATTRIBUTE_NAMES, VENDOR_ATTRIBUTE_CODES, dictionaries.m_vendorAttributes);
+      add_(VENDOR_ATTRIBUTE_VALUE_NAMES, VENDOR_ATTRIBUTE_VALUE_CODES, dictionaries.vendor_attribute_values_);
+
+      std::vector<TypeEntry> types;
+      types.reserve(dictionaries.m_attributeTypes.size());
+
+      for (const auto& [attribute_key, type_name] : dictionaries.m_attributeTypes)
+      {
+        types.push_back(TypeEntry{
+          attribute_key.vendor_id,
+          attribute_key.code,
+          dictionaries.get_attribute_value_type(attribute_key.code, attribute_key.vendor_id),
+          0,
+          intern_(type_name)});
+      }
+
+      std::sort(
+        types.begin(),
+        types.end(),
+        [](const TypeEntry& left, const TypeEntry& right)
+        {
+          return std::tie(left.vendor_id, left.code) < std::tie(right.vendor_id, right.code);
+        });
+
+      for (const auto& type : types)
+      {
+        append_(TYPES, type);
+      }
+
+      for (const auto& path : dictionaries.source_files())
+      {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        const auto modification_time = std::filesystem::last_write_time(path, ec);
+
+        append_(SOURCES, SourceEntry{
+          intern_(path),
+          0,
+          ec ? 0 : static_cast<uint64_t>(size),
+          ec ? 0 : modification_time.time_since_epoch().count()});
+      }
+    }
+
+    FrozenDictionaries build() const
+    {
+      Header header{};
+      header.magic = IMAGE_MAGIC;
+      header.version = IMAGE_VERSION;
+      header.byte_order = IMAGE_BYTE_ORDER;
+
+      size_t offset = align8(sizeof(Header));
+
+      for (size_t section = 0; section < SECTIONS_COUNT; ++section)
+      {
+        const auto& bytes = section == POOL ? pool_ : sections_[section];
+        header.sections[section].offset = static_cast<uint32_t>(offset);
+        header.sections[section].count = static_cast<uint32_t>(section == POOL ? pool_.size() : counts_[section]);
+        offset = align8(offset + bytes.size());
+      }
+
+      header.size = offset;
+
+      std::shared_ptr<uint8_t> image(new uint8_t[offset](), std::default_delete<uint8_t[]>());
+      std::memcpy(image.get(), &header, sizeof(header));
+
+      for (size_t section = 0; section < SECTIONS_COUNT; ++section)
+      {
+        const auto& bytes = section == POOL ? pool_ : sections_[section];
+        std::memcpy(image.get() + header.sections[section].offset, bytes.data(), bytes.size());
+      }
+
+      return FrozenDictionaries(std::move(image), offset);
+    }
+
+  private:
+    StringRef intern_(const std::string& string)
+    {
+      auto it = interned_.find(string);
+      if (it != interned_.end())
+      {
+        return it->second;
+      }
+
+      const StringRef ref{static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(string.size())};
+      pool_.insert(pool_.end(), string.begin(), string.end());
+      interned_.emplace(string, ref);
+      return ref;
+    }
+
+    template<typename Entry>
+    void append_(Section section, const Entry& entry)
+    {
+      auto& bytes = sections_[section];
+      const size_t offset = bytes.size();
+      bytes.resize(offset + sizeof(Entry));
+      std::memcpy(bytes.data() + offset, &entry, sizeof(Entry));
+      ++counts_[section];
+    }
+
+    // std::map iteration order is the order of lookup tables
+    void add_(Section names, Section codes, const BasicDictionary& dictionary)
+    {
+      for (const auto& [code, name] : dictionary.right_dict_)
+      {
+        append_(names, NameEntry{StringRef(), code, intern_(name)});
+      }
+
+      for (const auto& [name, code] : dictionary.reverse_dict_)
+      {
+        append_(codes, CodeEntry{StringRef(), intern_(name), code});
+      }
+    }
+
+    void add_(Section names, Section codes, const DependentDictionary& dictionary)
+    {
+      for (const auto& [key, name] : dictionary.right_dict_)
+      {
+        append_(names, NameEntry{intern_(key.first), key.second, intern_(name)});
+      }
+
+      for (const auto& [key, code] : dictionary.reverse_dict_)
+      {
+        append_(codes, CodeEntry{intern_(key.first), intern_(key.second), code});
+      }
+    }
+
+  private:
+    std::vector<uint8_t> pool_;
+    std::unordered_map<std::string, StringRef> interned_;
+    std::array<std::vector<uint8_t>, SECTIONS_COUNT> sections_;
+    std::array<size_t, SECTIONS_COUNT> counts_{};
+  };
+
+  FrozenDictionaries::FrozenDictionaries(const Dictionaries& dictionaries)
+    : FrozenDictionaries(Builder(dictionaries).build())
+  {}
+
+  FrozenDictionaries::FrozenDictionaries(std::shared_ptr<const uint8_t> image, size_t size)
+    : image_(std::move(image)),
+      size_(size),
+      header_(reinterpret_cast<const Header*>(image_.get()))
+  {}
+
+  FrozenDictionaries FrozenDictionaries::load(const std::string& image_path)
+  {
+    const int fd = ::open(image_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      throw std::runtime_error("Cannot open dictionary image " + image_path);
+    }
+
+    struct stat file_stat{};
+    if (::fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(Header))
+    {
+      ::close(fd);
+      throw std::runtime_error("Invalid dictionary image " + image_path);
+    }
+
+    const size_t size = static_cast<size_t>(file_stat.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+      throw std::runtime_error("Cannot map dictionary image " + image_path);
+    }
+
+    std::shared_ptr<const uint8_t> image(
+      static_cast<const uint8_t*>(mapping),
+      [size](const uint8_t* data) { ::munmap(const_cast<uint8_t*>(data), size); });
+
+    const auto* header = reinterpret_cast<const Header*>(image.get());
+
+    static const std::array<size_t, SECTIONS_COUNT> entry_sizes {
+      1,
+      sizeof(NameEntry), sizeof(CodeEntry),
+      sizeof(NameEntry), sizeof(CodeEntry),
+      sizeof(NameEntry), sizeof(CodeEntry),
+      sizeof(NameEntry), sizeof(CodeEntry),
+      sizeof(NameEntry), sizeof(CodeEntry),
+      sizeof(TypeEntry),
+      sizeof(SourceEntry)};
+
+    bool valid = header->magic == IMAGE_MAGIC &&
+      header->version == IMAGE_VERSION &&
+      header->byte_order == IMAGE_BYTE_ORDER &&
+      header->size == size;
+
+    for (size_t section = 0; valid && section < SECTIONS_COUNT; ++section)
+    {
+      const auto& ref = header->sections[section];
+      valid = ref.offset % 8 == 0 &&
+        ref.offset <= size &&
+        static_cast<uint64_t>(ref.count) * entry_sizes[section] <= size - ref.offset;
+    }
+
+    if (!valid)
+    {
+      throw std::runtime_error("Invalid dictionary image " + image_path);
+    }
+
+    FrozenDictionaries frozen(std::move(image), size);
+
+    if (!frozen.check_())
+    {
+      throw std::runtime_error("Invalid dictionary image " + image_path);
+    }
+
+    return frozen;
+  }
+
+  FrozenDictionaries
+  FrozenDictionaries::open(const std::string& dictionary_path, const std::string& image_path)
+  {
+    try
+    {
+      auto frozen = load(image_path);
+      const auto sources = frozen.source_files();
+
+      if (!sources.empty() && sources.front() == dictionary_path && frozen.is_up_to_date())
+      {
+        return frozen;
+      }
+    }
+    catch (const std::exception&)
+    {}
+
+    Dictionaries dictionaries(dictionary_path);
+    dictionaries.resolve();
+    FrozenDictionaries frozen(dictionaries);
+
+    try
+    {
+      frozen.save(image_path);
+    }
+    catch (const std::exception&)
+    {}
+
+    return frozen;
+  }
+
+  void FrozenDictionaries::save(const std::string& image_path) const
+  {
+    // readers of the previous image keep their mapping of the replaced file
+    const std::string temporary_path = image_path + ".tmp." + std::to_string(::getpid());
+
+    {
+      std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+      stream.write(reinterpret_cast<const char*>(image_.get()), static_cast<std::streamsize>(size_));
+      // the final flush can fail too (ENOSPC), a truncated image shouldn't replace the good one
+      stream.close();
+
+      if (!stream)
+      {
+        std::error_code ec;
+        std::filesystem::remove(temporary_path, ec);
+        throw std::runtime_error("Cannot write dictionary image " + image_path);
+      }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary_path, image_path, ec);
+
+    if (ec)
+    {
+      std::filesystem::remove(temporary_path, ec);
+      throw std::runtime_error("Cannot write dictionary image " + image_path);
+    }
+  }
+
+  bool FrozenDictionaries::is_up_to_date() const
+  {
+    const auto sources = section_<SourceEntry>(SOURCES);
+
+    for (const auto* source = sources.begin; source != sources.end; ++source)
+    {
+      const std::filesystem::path path(view_(source->path));
+
+      std::error_code ec;
+      const auto size = std::filesystem::file_size(path, ec);
+      if (ec || size != source->size)
+      {
+        return false;
+      }
+
+      const auto modification_time = std::filesystem::last_write_time(path, ec);
+      if (ec || modification_time.time_since_epoch().count() != source->modification_time)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  std::vector<std::string_view> FrozenDictionaries::source_files() const
+  {
+    const auto sources = section_<SourceEntry>(SOURCES);
+
+    std::vector<std::string_view> result;
+    result.reserve(sources.end - sources.begin);
+
+    for (const auto* source = sources.begin; source != sources.end; ++source)
+    {
+      result.push_back(view_(source->path));
+    }
+
+    return result;
+  }
+
+  std::string_view FrozenDictionaries::attribute_name(uint32_t code) const
+  {
+    return name_(ATTRIBUTE_NAMES, std::string_view(), code);
+  }
+
+  std::optional<uint32_t> FrozenDictionaries::attribute_code(std::string_view name) const
+  {
+    return code_(ATTRIBUTE_CODES, std::string_view(), name);
+  }
+
+  std::string_view FrozenDictionaries::vendor_name(uint32_t code) const
+  {
+    return name_(VENDOR_NAMES, std::string_view(), code);
+  }
+
+  std::optional<uint32_t> FrozenDictionaries::vendor_code(std::string_view name) const
+  {
+    return code_(VENDOR_CODES, std::string_view(), name);
+  }
+
+  std::string_view
+  FrozenDictionaries::vendor_attribute_name(std::string_view vendor_name, uint32_t code) const
+  {
+    return name_(VENDOR_ATTRIBUTE_NAMES, vendor_name, code);
+  }
+
+  std::optional<uint32_t>
+  FrozenDictionaries::vendor_attribute_code(std::string_view vendor_name, std::string_view name) const
+  {
+    return code_(VENDOR_ATTRIBUTE_CODES, vendor_name, name);
+  }
+
+  std::string_view
+  FrozenDictionaries::attribute_value_name(std::string_view attribute_name, uint32_t code) const
+  {
+    return name_(ATTRIBUTE_VALUE_NAMES, attribute_name, code);
+  }
+
+  std::optional<uint32_t>
+  FrozenDictionaries::attribute_value_code(std::string_view attribute_name, std::string_view name) const
+  {
+    return code_(ATTRIBUTE_VALUE_CODES, attribute_name, name);
+  }
+
+  std::string_view
+  FrozenDictionaries::vendor_attribute_value_name(std::string_view value_name, uint32_t code) const
+  {
+    return name_(VENDOR_ATTRIBUTE_VALUE_NAMES, value_name, code);
+  }
+
+  std::optional<uint32_t>
+  FrozenDictionaries::vendor_attribute_value_code(std::string_view value_name, std::string_view name) const
+  {
+    return code_(VENDOR_ATTRIBUTE_VALUE_CODES, value_name, name);
+  }
+
+  std::string_view
+  FrozenDictionaries::attribute_type_name(uint8_t code, uint32_t vendor_id) const
+  {
+    const TypeEntry* entry = type_(code, vendor_id);
+    return entry ? view_(entry->type_name) : std::string_view();
+  }
+
+  std::optional<std::string_view> FrozenDictionaries::find_attribute_name(uint32_t code) const
+  {
+    const auto name = attribute_name(code);
+    return !name.empty() ? std::optional<std::string_view>(name) : std::nullopt;
+  }
+
+  std::optional<uint32_t> FrozenDictionaries::find_attribute_code(std::string_view name) const
+  {
+    return attribute_code(name);
+  }
+
+  std::optional<std::string_view>
+  FrozenDictionaries::find_attribute_type(uint8_t code, uint32_t vendor_id) const
+  {
+    const TypeEntry* entry = type_(code, vendor_id);
+    return entry ? std::optional<std::string_view>(view_(entry->type_name)) : std::nullopt;
+  }
+
+  AttributeValueType
+  FrozenDictionaries::get_attribute_value_type(uint8_t code, uint32_t vendor_id) const
+  {
+    const TypeEntry* entry = type_(code, vendor_id);
+    return entry ? entry->type : AttributeValueType::NONE;
+  }
+
+  std::optional<AttributeKey>
+  FrozenDictionaries::get_attribute_key(std::string_view attribute_name, std::string_view vendor_name) const
+  {
+    const auto vendor_id = vendor_code(vendor_name);
+    if (!vendor_id)
+    {
+      return std::nullopt;
+    }
+
+    const auto code = vendor_attribute_code(vendor_name, attribute_name);
+    if (!code)
+    {
+      return std::nullopt;
+    }
+
+    return AttributeKey(static_cast<uint8_t>(*code), *vendor_id);
+  }
+
+  bool FrozenDictionaries::check_() const
+  {
+    for (Section section : {ATTRIBUTE_NAMES, VENDOR_NAMES, ATTRIBUTE_VALUE_NAMES,
+      VENDOR_ATTRIBUTE_NAMES, VENDOR_ATTRIBUTE_VALUE_NAMES})
+    {
+      if (!check_names_(section))
+      {
+        return false;
+      }
+    }
+
+    for (Section section : {ATTRIBUTE_CODES, VENDOR_CODES, ATTRIBUTE_VALUE_CODES,
+      VENDOR_ATTRIBUTE_CODES, VENDOR_ATTRIBUTE_VALUE_CODES})
+    {
+      if (!check_codes_(section))
+      {
+        return false;
+      }
+    }
+
+    const auto types = section_<TypeEntry>(TYPES);
+
+    for (const auto* type = types.begin; type != types.end; ++type)
+    {
+      if (!check_ref_(type->type_name) ||
+        static_cast<uint8_t>(type->type) > static_cast<uint8_t>(AttributeValueType::UINT64) ||
+        (type != types.begin &&
+          std::tie((type - 1)->vendor_id, (type - 1)->code) >= std::tie(type->vendor_id, type->code)))
+      {
+        return false;
+      }
+    }
+
+    const auto sources = section_<SourceEntry>(SOURCES);
+
+    for (const auto* source = sources.begin; source != sources.end; ++source)
+    {
+      if (!check_ref_(source->path))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool FrozenDictionaries::check_ref_(const StringRef& ref) const
+  {
+    return static_cast<uint64_t>(ref.offset) + ref.size <= header_->sections[POOL].count;
+  }
+
+  bool FrozenDictionaries::check_names_(Section section) const
+  {
+    const auto names = section_<NameEntry>(section);
+
+    for (const auto* entry = names.begin; entry != names.end; ++entry)
+    {
+      if (!check_ref_(entry->dependency) || !check_ref_(entry->name))
+      {
+        return false;
+      }
+
+      // lookups are binary searches by (dependency, code)
+      if (entry != names.begin)
+      {
+        const auto* previous = entry - 1;
+        const int compare = view_(previous->dependency).compare(view_(entry->dependency));
+
+        if (compare > 0 || (compare == 0 && previous->code >= entry->code))
+        {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  bool FrozenDictionaries::check_codes_(Section section) const
+  {
+    const auto codes = section_<CodeEntry>(section);
+
+    for (const auto* entry = codes.begin; entry != codes.end; ++entry)
+    {
+      if (!check_ref_(entry->dependency) || !check_ref_(entry->name))
+      {
+        return false;
+      }
+
+      // lookups are binary searches by (dependency, name)
+      if (entry != codes.begin)
+      {
+        const auto* previous = entry - 1;
+        const int compare = view_(previous->dependency).compare(view_(entry->dependency));
+
+        if (compare > 0 || (compare == 0 && view_(previous->name) >= view_(entry->name)))
+        {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  template<typename Entry>
+  FrozenDictionaries::Span<Entry>
+  FrozenDictionaries::section_(Section section) const
+  {
+    const auto& ref = header_->sections[section];
+    const auto* begin = reinterpret_cast<const Entry*>(image_.get() + ref.offset);
+    return Span<Entry>{begin, begin + ref.count};
+  }
+
+  std::string_view
+  FrozenDictionaries::view_(const StringRef& ref) const
+  {
+    const auto& pool = header_->sections[POOL];
+    return std::string_view(reinterpret_cast<const char*>(image_.get()) + pool.offset + ref.offset, ref.size);
+  }
+
+  std::string_view
+  FrozenDictionaries::name_(Section section, std::string_view dependency, uint32_t code) const
+  {
+    const auto names = section_<NameEntry>(section);
+
+    auto it = std::lower_bound(
+      names.begin,
+      names.end,
+      std::make_pair(dependency, code),
+      [this](const NameEntry& entry, const std::pair<std::string_view, uint32_t>& key)
+      {
+        const int compare = view_(entry.dependency).compare(key.first);
+        return compare < 0 || (compare == 0 && entry.code < key.second);
+      });
+
+    if (it != names.end && it->code == code && view_(it->dependency) == dependency)
+    {
+      return view_(it->name);
+    }
+
+    return std::string_view();
+  }
+
+  std::optional<uint32_t>
+  FrozenDictionaries::code_(Section section, std::string_view dependency, std::string_view name) const
+  {
+    const auto codes = section_<CodeEntry>(section);
+
+    auto it = std::lower_bound(
+      codes.begin,
+      codes.end,
+      std::make_pair(dependency, name),
+      [this](const CodeEntry& entry, const std::pair<std::string_view, std::string_view>& key)
+      {
+        const int compare = view_(entry.dependency).compare(key.first);
+        return compare < 0 || (compare == 0 && view_(entry.name) < key.second);
+      });
+
+    if (it != codes.end && view_(it->name) == name && view_(it->dependency) == dependency)
+    {
+      return it->code;
+    }
+
+    return std::nullopt;
+  }
+
+  const FrozenDictionaries::TypeEntry*
+  FrozenDictionaries::type_(uint8_t code, uint32_t vendor_id) const
+  {
+    const auto types = section_<TypeEntry>(TYPES);
+
+    auto it = std::lower_bound(
+      types.begin,
+      types.end,
+      std::make_pair(vendor_id, code),
+      [](const TypeEntry& entry, const std::pair<uint32_t, uint8_t>& key)
+      {
+        return std::tie(entry.vendor_id, entry.code) < std::tie(key.first, key.second);
+      });
+
+    if (it != types.end && it->vendor_id == vendor_id && it->code == code)
+    {
+      return &*it;
+    }
+
+    return nullptr;
+  }
+}
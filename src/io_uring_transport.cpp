@@ -0,0 +1,654 @@
+#include "io_uring_transport.h"
+
+#ifdef RADIUS_LITE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using boost::asio::ip::udp;
+using boost::system::error_code;
+
+namespace radius_lite
+{
+  namespace
+  {
+    const unsigned SQ_ENTRIES = 256;
+    const unsigned CQ_ENTRIES = 4096;
+
+    // power of 2, every buffer holds io_uring_recvmsg_out, source address and payload
+    const unsigned BUFFERS_COUNT = 256;
+    const size_t MAX_DATAGRAM_SIZE = 4096;
+    const size_t ADDRESS_SIZE = sizeof(sockaddr_in6);
+    const size_t BUFFER_SIZE = sizeof(io_uring_recvmsg_out) + ADDRESS_SIZE + MAX_DATAGRAM_SIZE;
+
+    // completed send operations kept for reuse
+    const size_t MAX_FREE_SEND_OPS = 1024;
+
+    // user_data of operations, sends use the address of their SendOp_
+    const uint64_t RECEIVE_TAG = 0;
+    const uint64_t CANCEL_TAG = 1;
+
+    int ioUringSetup(unsigned entries, io_uring_params* params)
+    {
+      return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+      return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned args_count)
+    {
+      return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, args_count));
+    }
+
+    bool opcodesSupported(int ring_fd)
+    {
+      const size_t ops_count = 256;
+      std::vector<uint8_t> memory(sizeof(io_uring_probe) + ops_count * sizeof(io_uring_probe_op));
+      io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+
+      if (ioUringRegister(ring_fd, IORING_REGISTER_PROBE, probe, ops_count) < 0)
+      {
+        return false;
+      }
+
+      auto supported = [probe](uint8_t op)
+      {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+      };
+
+      return supported(IORING_OP_RECVMSG) && supported(IORING_OP_SENDMSG) && supported(IORING_OP_ASYNC_CANCEL);
+    }
+
+    template<typename T>
+    T loadAcquire(const T* value)
+    {
+      return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    }
+
+    template<typename T>
+    void storeRelease(T* target, T value)
+    {
+      __atomic_store_n(target, value, __ATOMIC_RELEASE);
+    }
+  }
+
+  std::unique_ptr<IoUringTransport>
+  IoUringTransport::create(
+    boost::asio::io_service& io_service,
+    int socket_fd,
+    const ReceiveFun& receive_callback,
+    Socket::IoStats& io_stats)
+  {
+    std::unique_ptr<IoUringTransport> transport(
+      new IoUringTransport(io_service, socket_fd, receive_callback, io_stats));
+
+    if (!transport->init_())
+    {
+      return nullptr;
+    }
+
+    return transport;
+  }
+
+  IoUringTransport::IoUringTransport(
+    boost::asio::io_service& io_service,
+    int socket_fd,
+    const ReceiveFun& receive_callback,
+    Socket::IoStats& io_stats)
+    : io_service_(io_service),
+      event_descriptor_(io_service),
+      socket_fd_(socket_fd),
+      receive_callback_(receive_callback),
+      io_stats_(io_stats),
+      ring_fd_(-1),
+      event_fd_(-1),
+      ring_memory_(MAP_FAILED),
+      ring_memory_size_(0),
+      sqes_(nullptr),
+      sqes_size_(0),
+      sq_head_(nullptr),
+      sq_tail_(nullptr),
+      sq_array_(nullptr),
+      sq_mask_(0),
+      sq_entries_(0),
+      sq_local_tail_(0),
+      to_submit_(0),
+      cq_head_(nullptr),
+      cq_tail_(nullptr),
+      cq_mask_(0),
+      cqes_(nullptr),
+      buffer_ring_(nullptr),
+      buffer_ring_size_(0),
+      buffer_ring_tail_(0),
+      receive_message_(),
+      receiving_(false),
+      submit_ordered_(false),
+      send_to_submit_(false),
+      stopping_(false),
+      pending_sends_(0),
+      pending_send_ops_(nullptr)
+  {}
+
+  IoUringTransport::~IoUringTransport()
+  {
+    stopping_ = true;
+
+    if (ring_fd_ >= 0 && sqes_ && (receiving_ || pending_sends_ > 0))
+    {
+      io_uring_sqe* sqe = get_sqe_();
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->fd = -1;
+      sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+      sqe->user_data = CANCEL_TAG;
+      submit_();
+
+      // kernel can reference buffers of pending operations until they complete,
+      // nothing completes if it didn't accept the cancel
+      while (to_submit_ == 0 && (receiving_ || pending_sends_ > 0))
+      {
+        if (ioUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+          break;
+        }
+
+        reap_();
+      }
+    }
+
+    if (buffer_ring_)
+    {
+      ::munmap(buffer_ring_, buffer_ring_size_);
+    }
+
+    if (sqes_)
+    {
+      ::munmap(sqes_, sqes_size_);
+    }
+
+    if (ring_memory_ != MAP_FAILED)
+    {
+      ::munmap(ring_memory_, ring_memory_size_);
+    }
+
+    if (ring_fd_ >= 0)
+    {
+      ::close(ring_fd_);
+    }
+
+    // left if waiting failed: the kernel drops its references with the ring
+    while (pending_send_ops_)
+    {
+      std::unique_ptr<SendOp_> op(pending_send_ops_);
+      unlink_send_(op.get());
+      op->buffer.reset();
+      op->callback(boost::asio::error::operation_aborted);
+    }
+  }
+
+  void IoUringTransport::start()
+  {
+    // receive is armed by init_
+    wait_();
+  }
+
+  void IoUringTransport::send(
+    PacketBufferPtr&& datagram,
+    const udp::endpoint& destination,
+    const SendFun& callback)
+  {
+    // pointers of the message refer to the operation, it lives until its completion,
+    // completed operations are reused
+    SendOp_* op;
+    if (!free_send_ops_.empty())
+    {
+      op = free_send_ops_.back().release();
+      free_send_ops_.pop_back();
+    }
+    else
+    {
+      op = new SendOp_();
+    }
+
+    op->buffer = std::move(datagram);
+    op->destination = destination;
+    op->callback = callback;
+    op->iov.iov_base = op->buffer->data();
+    op->iov.iov_len = op->buffer->size();
+    op->message = msghdr();
+    op->message.msg_name = op->destination.data();
+    op->message.msg_namelen = static_cast<socklen_t>(op->destination.size());
+    op->message.msg_iov = &op->iov;
+    op->message.msg_iovlen = 1;
+
+    io_uring_sqe* sqe = get_sqe_();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = socket_fd_;
+    sqe->addr = reinterpret_cast<uintptr_t>(&op->message);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+    link_send_(op);
+    send_to_submit_ = true;
+
+    if (!submit_ordered_)
+    {
+      submit_ordered_ = true;
+      io_service_.post(
+        [this]
+        {
+          submit_ordered_ = false;
+          submit_();
+        });
+    }
+  }
+
+  bool IoUringTransport::init_()
+  {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = CQ_ENTRIES;
+
+    ring_fd_ = ioUringSetup(SQ_ENTRIES, &params);
+    if (ring_fd_ < 0 || (params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+    {
+      return false;
+    }
+
+    ring_memory_size_ = std::max(
+      params.sq_off.array + params.sq_entries * sizeof(unsigned),
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    ring_memory_ = ::mmap(
+      nullptr,
+      ring_memory_size_,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      ring_fd_,
+      IORING_OFF_SQ_RING);
+    if (ring_memory_ == MAP_FAILED)
+    {
+      return false;
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(
+      nullptr,
+      sqes_size_,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      ring_fd_,
+      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+      return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    uint8_t* ring = static_cast<uint8_t*>(ring_memory_);
+    sq_head_ = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+    cq_head_ = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    if (!opcodesSupported(ring_fd_))
+    {
+      return false;
+    }
+
+    event_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0)
+    {
+      return false;
+    }
+    event_descriptor_.assign(event_fd_);
+
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_EVENTFD, &event_fd_, 1) < 0)
+    {
+      return false;
+    }
+
+    buffer_ring_size_ = BUFFERS_COUNT * sizeof(io_uring_buf);
+    void* buffer_ring = ::mmap(
+      nullptr,
+      buffer_ring_size_,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+    if (buffer_ring == MAP_FAILED)
+    {
+      return false;
+    }
+    buffer_ring_ = static_cast<io_uring_buf*>(buffer_ring);
+
+    io_uring_buf_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uintptr_t>(buffer_ring_);
+    registration.ring_entries = BUFFERS_COUNT;
+    registration.bgid = 0;
+
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+      return false;
+    }
+
+    buffers_.resize(BUFFERS_COUNT * BUFFER_SIZE);
+    for (unsigned i = 0; i < BUFFERS_COUNT; ++i)
+    {
+      recycle_buffer_(static_cast<uint16_t>(i));
+    }
+
+    // layout of every received buffer: no control messages, source address of fixed size
+    receive_message_.msg_namelen = ADDRESS_SIZE;
+    receive_message_.msg_controllen = 0;
+
+    return probe_receive_();
+  }
+
+  bool IoUringTransport::probe_receive_()
+  {
+    // multishot recvmsg (6.0) isn't visible in the opcode probe: older kernels
+    // complete it at once with EINVAL, otherwise it stays armed until a datagram comes
+    arm_receive_();
+    submit_();
+
+    if (to_submit_ != 0)
+    {
+      // kernel didn't take the receive: withdraw it, there is nothing to wait for
+      sq_local_tail_ -= to_submit_;
+      storeRelease(sq_tail_, sq_local_tail_);
+      to_submit_ = 0;
+      receiving_ = false;
+      return false;
+    }
+
+    for (unsigned head = *cq_head_; head != loadAcquire(cq_tail_); ++head)
+    {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+
+      if (cqe.user_data == RECEIVE_TAG && cqe.res == -EINVAL)
+      {
+        receiving_ = false;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  io_uring_sqe* IoUringTransport::get_sqe_()
+  {
+    if (sq_local_tail_ - loadAcquire(sq_head_) >= sq_entries_)
+    {
+      // SQEs are consumed by io_uring_enter, so the queue is free after it
+      submit_();
+    }
+
+    const unsigned index = sq_local_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sq_local_tail_;
+    ++to_submit_;
+    return sqe;
+  }
+
+  void IoUringTransport::submit_()
+  {
+    if (to_submit_ == 0)
+    {
+      return;
+    }
+
+    storeRelease(sq_tail_, sq_local_tail_);
+
+    int result;
+    do
+    {
+      result = ioUringEnter(ring_fd_, to_submit_, 0, 0);
+    }
+    while (result < 0 && errno == EINTR);
+
+    // receive re-arming isn't a send call
+    if (send_to_submit_)
+    {
+      send_to_submit_ = false;
+      ++io_stats_.send_calls;
+    }
+
+    if (result < 0)
+    {
+      ++io_stats_.transport_errors;
+      return;
+    }
+
+    to_submit_ -= std::min(to_submit_, static_cast<unsigned>(result));
+  }
+
+  void IoUringTransport::arm_receive_()
+  {
+    io_uring_sqe* sqe = get_sqe_();
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket_fd_;
+    sqe->addr = reinterpret_cast<uintptr_t>(&receive_message_);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->user_data = RECEIVE_TAG;
+    receiving_ = true;
+  }
+
+  void IoUringTransport::wait_()
+  {
+    event_descriptor_.async_wait(
+      boost::asio::posix::stream_descriptor::wait_read,
+      [this](const error_code& error)
+      {
+        if (error)
+        {
+          return;
+        }
+
+        uint64_t value;
+        if (::read(event_fd_, &value, sizeof(value)) < 0 && errno != EAGAIN)
+        {
+          ++io_stats_.transport_errors;
+        }
+        ++io_stats_.receive_calls;
+
+        reap_();
+        submit_();
+        wait_();
+      });
+  }
+
+  void IoUringTransport::reap_()
+  {
+    unsigned head = *cq_head_;
+
+    while (head != loadAcquire(cq_tail_))
+    {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      const uint64_t user_data = cqe.user_data;
+      const int32_t result = cqe.res;
+      const uint32_t flags = cqe.flags;
+
+      // the slot is released before the callback, that can submit new operations
+      storeRelease(cq_head_, ++head);
+
+      if (user_data == RECEIVE_TAG)
+      {
+        handle_receive_(result, flags);
+      }
+      else if (user_data != CANCEL_TAG)
+      {
+        std::unique_ptr<SendOp_> op(reinterpret_cast<SendOp_*>(user_data));
+        unlink_send_(op.get());
+        op->buffer.reset();
+
+        // canceled sends complete with ECANCELED, that is operation_aborted
+        const error_code ec = result < 0 ? error_code(-result, boost::system::system_category()) : error_code();
+        io_stats_.sent += ec ? 0 : 1;
+        op->callback(ec);
+
+        if (!stopping_)
+        {
+          op->callback = nullptr;
+
+          if (free_send_ops_.size() < MAX_FREE_SEND_OPS)
+          {
+            free_send_ops_.push_back(std::move(op));
+          }
+        }
+      }
+    }
+  }
+
+  void IoUringTransport::handle_receive_(int32_t result, uint32_t flags)
+  {
+    if ((flags & IORING_CQE_F_MORE) == 0)
+    {
+      receiving_ = false;
+    }
+
+    if (result < 0)
+    {
+      // canceled or the socket is closed: receiving is finished
+      if (result == -ECANCELED || result == -EBADF || result == -ENOTSOCK)
+      {
+        return;
+      }
+
+      // ENOBUFS: all buffers are in use, receive is re-armed below after they are returned
+      if (result != -ENOBUFS && !stopping_)
+      {
+        receive_callback_(error_code(-result, boost::system::system_category()), nullptr, 0, udp::endpoint());
+      }
+    }
+    else if ((flags & IORING_CQE_F_BUFFER) != 0)
+    {
+      const uint16_t buffer_id = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+      const uint8_t* buffer = buffers_.data() + buffer_id * BUFFER_SIZE;
+
+      io_uring_recvmsg_out out;
+      std::memcpy(&out, buffer, sizeof(out));
+
+      udp::endpoint source;
+      const size_t address_size = std::min<size_t>(out.namelen, ADDRESS_SIZE);
+      std::memcpy(source.data(), buffer + sizeof(out), address_size);
+      source.resize(address_size);
+
+      if (!stopping_)
+      {
+        if ((out.flags & MSG_TRUNC) != 0)
+        {
+          receive_callback_(boost::asio::error::message_size, nullptr, 0, source);
+        }
+        else
+        {
+          receive_callback_(error_code(), buffer + sizeof(out) + ADDRESS_SIZE, out.payloadlen, source);
+        }
+      }
+
+      recycle_buffer_(buffer_id);
+    }
+
+    if (!receiving_ && !stopping_)
+    {
+      arm_receive_();
+    }
+  }
+
+  void IoUringTransport::link_send_(SendOp_* op)
+  {
+    op->prev = nullptr;
+    op->next = pending_send_ops_;
+
+    if (pending_send_ops_)
+    {
+      pending_send_ops_->prev = op;
+    }
+
+    pending_send_ops_ = op;
+    ++pending_sends_;
+  }
+
+  void IoUringTransport::unlink_send_(SendOp_* op)
+  {
+    if (op->prev)
+    {
+      op->prev->next = op->next;
+    }
+    else
+    {
+      pending_send_ops_ = op->next;
+    }
+
+    if (op->next)
+    {
+      op->next->prev = op->prev;
+    }
+
+    --pending_sends_;
+  }
+
+  void IoUringTransport::recycle_buffer_(uint16_t buffer_id)
+  {
+    // entries are addressed directly: io_uring_buf_ring::bufs has another offset in C++,
+    // its flexible array is wrapped into an empty struct that isn't empty for C++
+    io_uring_buf& entry = buffer_ring_[buffer_ring_tail_ & (BUFFERS_COUNT - 1)];
+    entry.addr = reinterpret_cast<uintptr_t>(buffers_.data() + buffer_id * BUFFER_SIZE);
+    entry.len = static_cast<uint32_t>(BUFFER_SIZE);
+    entry.bid = buffer_id;
+
+    storeRelease(&buffer_ring_[0].resv, ++buffer_ring_tail_);
+  }
+}
+
+#else
+
+namespace radius_lite
+{
+  // io_uring headers aren't available at build time, Socket falls back to asio
+  std::unique_ptr<IoUringTransport>
+  IoUringTransport::create(
+    boost::asio::io_service& /*io_service*/,
+    int /*socket_fd*/,
+    const ReceiveFun& /*receive_callback*/,
+    Socket::IoStats& /*io_stats*/)
+  {
+    return nullptr;
+  }
+
+  IoUringTransport::~IoUringTransport()
+  {}
+
+  void IoUringTransport::start()
+  {}
+
+  void IoUringTransport::send(
+    PacketBufferPtr&& /*datagram*/,
+    const boost::asio::ip::udp::endpoint& /*destination*/,
+    const SendFun& /*callback*/)
+  {}
+}
+
+#endif
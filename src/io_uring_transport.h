@@ -0,0 +1,150 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <cstdint> //uint8_t, uint32_t
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "packet_buffer.h"
+#include "socket.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+namespace radius_lite
+{
+  // Linux io_uring receive/send path of Socket: one multishot recvmsg over a ring
+  // of provided buffers and sendmsg SQEs that are submitted by one io_uring_enter per batch.
+  // Completions are signalled through an eventfd waited on the io_service,
+  // so callbacks are called on the io_service thread as on the asio path.
+  class IoUringTransport
+  {
+  public:
+    // buffer and source are valid only during the call
+    using ReceiveFun = std::function<void(
+      const boost::system::error_code&,
+      const uint8_t*,
+      std::size_t,
+      const boost::asio::ip::udp::endpoint&)>;
+
+    using SendFun = std::function<void(const boost::system::error_code&)>;
+
+  public:
+    // nullptr if the kernel doesn't support io_uring, provided buffer rings
+    // or multishot recvmsg (Linux 6.0), the caller should use the asio path then;
+    // the receive is armed here. Wakeups are counted as receive calls of io_stats,
+    // io_uring_enter calls that submit sends as send calls
+    static std::unique_ptr<IoUringTransport> create(
+      boost::asio::io_service& io_service,
+      int socket_fd,
+      const ReceiveFun& receive_callback,
+      Socket::IoStats& io_stats);
+
+    // cancels pending operations and waits for their completion, receive callback isn't called,
+    // callbacks of sends that didn't complete get boost::asio::error::operation_aborted
+    ~IoUringTransport();
+
+    IoUringTransport(const IoUringTransport&) = delete;
+    IoUringTransport& operator=(const IoUringTransport&) = delete;
+
+    // waits for completions, should be called on the io_service thread
+    void start();
+
+    // queues sendmsg, sends queued by the current handlers are submitted together
+    void send(
+      PacketBufferPtr&& datagram,
+      const boost::asio::ip::udp::endpoint& destination,
+      const SendFun& callback);
+
+  private:
+    struct SendOp_
+    {
+      PacketBufferPtr buffer;
+      boost::asio::ip::udp::endpoint destination;
+      iovec iov;
+      msghdr message;
+      SendFun callback;
+      // list of operations the kernel can reference
+      SendOp_* prev;
+      SendOp_* next;
+    };
+
+  private:
+    IoUringTransport(
+      boost::asio::io_service& io_service,
+      int socket_fd,
+      const ReceiveFun& receive_callback,
+      Socket::IoStats& io_stats);
+
+    bool init_();
+
+    // arms the multishot receive, false if the kernel rejects it
+    bool probe_receive_();
+
+    io_uring_sqe* get_sqe_();
+
+    void submit_();
+
+    void arm_receive_();
+
+    void wait_();
+
+    void reap_();
+
+    void handle_receive_(int32_t result, uint32_t flags);
+
+    void recycle_buffer_(uint16_t buffer_id);
+
+    void link_send_(SendOp_* op);
+
+    void unlink_send_(SendOp_* op);
+
+  private:
+    boost::asio::io_service& io_service_;
+    boost::asio::posix::stream_descriptor event_descriptor_;
+    const int socket_fd_;
+    const ReceiveFun receive_callback_;
+    Socket::IoStats& io_stats_;
+
+    int ring_fd_;
+    int event_fd_;
+
+    // submission and completion queues share one mapping
+    void* ring_memory_;
+    size_t ring_memory_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_local_tail_;
+    unsigned to_submit_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+
+    // provided buffers of the multishot recvmsg, the ring tail overlays resv of the first entry
+    io_uring_buf* buffer_ring_;
+    size_t buffer_ring_size_;
+    uint16_t buffer_ring_tail_;
+    std::vector<uint8_t> buffers_;
+    msghdr receive_message_;
+
+    bool receiving_;
+    bool submit_ordered_;
+    // a send is among the SQEs of the next submit
+    bool send_to_submit_;
+    bool stopping_;
+    size_t pending_sends_;
+    SendOp_* pending_send_ops_;
+    std::vector<std::unique_ptr<SendOp_>> free_send_ops_;
+  };
+}
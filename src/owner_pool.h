@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace radius_lite
+{
+  // Per-thread pool of T that takes objects back from any thread.
+  // Objects return into the pool of the thread that created them: the owning thread
+  // pushes and pops its vector without locks, other threads push into a lock-free list
+  // that the owner takes at once when its vector is empty.
+  // The pool lives until its thread exits and every object handed out is returned.
+  // T has members owner_pool_ (OwnerPool<T>*) and owner_pool_next_ (T*), MAX_POOLED
+  // is defined by the translation unit of T.
+  template<typename T>
+  class OwnerPool
+  {
+  public:
+    // objects above this count are freed on release instead of being pooled
+    static const size_t MAX_POOLED;
+
+  public:
+    // pooled object of the calling thread, nullptr if the pool is empty
+    static T* acquire()
+    {
+      OwnerPool& pool = local_();
+
+      if (pool.pooled_.empty())
+      {
+        pool.collect_();
+
+        if (pool.pooled_.empty())
+        {
+          return nullptr;
+        }
+      }
+
+      T* object = pool.pooled_.back().release();
+      pool.pooled_.pop_back();
+      pool.references_.fetch_add(1, std::memory_order_relaxed);
+      return object;
+    }
+
+    // new object that belongs to the pool of the calling thread
+    static T* adopt(T* object)
+    {
+      OwnerPool& pool = local_();
+      object->owner_pool_ = &pool;
+      pool.references_.fetch_add(1, std::memory_order_relaxed);
+      return object;
+    }
+
+    // can be called on any thread
+    static void release(T* object)
+    {
+      OwnerPool* pool = object->owner_pool_;
+
+      if (!pool)
+      {
+        delete object;
+        return;
+      }
+
+      if (pool == current_())
+      {
+        if (pool->pooled_.size() < MAX_POOLED)
+        {
+          pool->pooled_.emplace_back(object);
+        }
+        else
+        {
+          delete object;
+        }
+      }
+      else
+      {
+        T* head = pool->returned_.load(std::memory_order_relaxed);
+
+        do
+        {
+          object->owner_pool_next_ = head;
+        }
+        while (!pool->returned_.compare_exchange_weak(
+          head, object, std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      pool->unref_();
+    }
+
+  private:
+    struct Holder_
+    {
+      Holder_()
+        : pool(new OwnerPool())
+      {
+        current_() = pool;
+      }
+
+      ~Holder_()
+      {
+        // objects released later by other threads are freed with the pool
+        current_() = nullptr;
+        pool->pooled_.clear();
+        pool->unref_();
+      }
+
+      OwnerPool* pool;
+    };
+
+  private:
+    OwnerPool()
+      : references_(1),
+        returned_(nullptr)
+    {}
+
+    ~OwnerPool()
+    {
+      collect_();
+    }
+
+    static OwnerPool*& current_()
+    {
+      thread_local OwnerPool* pool = nullptr;
+      return pool;
+    }
+
+    static OwnerPool& local_()
+    {
+      thread_local Holder_ holder;
+      return *holder.pool;
+    }
+
+    void collect_()
+    {
+      T* object = returned_.exchange(nullptr, std::memory_order_acquire);
+
+      while (object)
+      {
+        T* next = object->owner_pool_next_;
+
+        if (pooled_.size() < MAX_POOLED && current_() == this)
+        {
+          pooled_.emplace_back(object);
+        }
+        else
+        {
+          delete object;
+        }
+
+        object = next;
+      }
+    }
+
+    // held by the thread and by every object handed out
+    void unref_()
+    {
+      if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        delete this;
+      }
+    }
+
+  private:
+    std::atomic<size_t> references_;
+    std::vector<std::unique_ptr<T>> pooled_;
+    std::atomic<T*> returned_;
+  };
+}
@@ -1,6 +1,8 @@
 #include "packet.h"
 #include "error.h"
 #include "attribute_types.h"
+#include "packet_codes.h"
+#include "utils.h"
 #include <openssl/md5.h>
 #include <stdexcept>
 #include <iostream>
@@ -10,109 +12,237 @@ using Packet = radius_lite::Packet;
 
 namespace
 {
-    radius_lite::Attribute* makeAttribute(
+    // places attribute into the packet arena when it is given, otherwise on the heap
+    template<typename AttributeType, typename... Args>
+    radius_lite::AttributeHolder createAttribute(radius_lite::PacketArena* arena, Args&&... args)
+    {
+        if (arena)
+        {
+            void* place = arena->allocate(sizeof(AttributeType), alignof(AttributeType));
+            return radius_lite::AttributeHolder(
+                new (place) AttributeType(std::forward<Args>(args)...),
+                radius_lite::AttributeDeleter{true});
+        }
+
+        return radius_lite::AttributeHolder(new AttributeType(std::forward<Args>(args)...));
+    }
+
+    radius_lite::AttributeHolder makeAttribute(
         uint8_t type,
         const uint8_t* data,
         size_t size,
-        const std::string& secret,
-        const std::array<uint8_t, 16>& auth)
+        const radius_lite::SecretContext& secret,
+        const std::array<uint8_t, 16>& auth,
+        const radius_lite::AttributeDecodeTable& decodeTable,
+        radius_lite::PacketArena* arena)
     {
-      //std::cerr << "makeAttribute: type = " << static_cast<unsigned int>(type) << std::endl;
-        if (type == 1 || type == 11 || type == 18 || type == 22 || type == 34 || type == 35 || type == 60 || type == 63)
-            return new radius_lite::String(type, data, size);
-        else if (type == 2)
-            return new radius_lite::Encrypted(type, data, size, secret, auth);
-        else if (type == 3)
-            return new radius_lite::ChapPassword(type, data, size);
-        else if (type == 4 || type == 8 || type == 9 || type == 14)
-            return new radius_lite::IpAddress(type, data, size);
-        else if (type == 5 || type == 6 || type == 7 || type == 10 || type == 12 || type == 13 || type == 15 || type == 16 || type == 27 || type == 28 || type == 29 || type == 37 || type == 38 || type == 61 || type == 62)
-            return new radius_lite::Integer<uint64_t>(type, data, size);
-        else
-            return new radius_lite::Bytes(type, data, size);
+        using namespace radius_lite;
+        using Kind = AttributeDecodeTable::Kind;
+
+        std::pmr::memory_resource* resource = arena ? arena : std::pmr::get_default_resource();
+
+        switch (decodeTable.kind(type))
+        {
+            case Kind::STRING:
+                return createAttribute<String>(arena, type, data, size, resource);
+            case Kind::ENCRYPTED:
+                return createAttribute<Encrypted>(arena, type, data, size, secret, auth, resource);
+            case Kind::CHAP_PASSWORD:
+                return createAttribute<ChapPassword>(arena, type, data, size, resource);
+            case Kind::IP_ADDRESS:
+                return createAttribute<IpAddress>(arena, type, data, size);
+            case Kind::INTEGER8:
+                return createAttribute<Integer<uint8_t>>(arena, type, data, size);
+            case Kind::INTEGER16:
+                return createAttribute<Integer<uint16_t>>(arena, type, data, size);
+            case Kind::INTEGER32:
+                return createAttribute<Integer<uint32_t>>(arena, type, data, size);
+            case Kind::INTEGER64:
+                return createAttribute<Integer<uint64_t>>(arena, type, data, size);
+            case Kind::BYTES:
+                return createAttribute<Bytes>(arena, type, data, size, resource);
+        }
 
         throw radius_lite::Exception(radius_lite::Error::invalidAttributeType);
     }
+
+    // sizes accepted by the attribute constructors makeAttribute calls
+    bool validAttributeSize(radius_lite::AttributeDecodeTable::Kind kind, size_t size)
+    {
+        using Kind = radius_lite::AttributeDecodeTable::Kind;
+
+        switch (kind)
+        {
+            case Kind::ENCRYPTED:
+                return size <= 128;
+            case Kind::CHAP_PASSWORD:
+                return size == 17;
+            case Kind::IP_ADDRESS:
+                return size == 4;
+            case Kind::INTEGER8:
+                return size == 1;
+            case Kind::INTEGER16:
+                return size == 1 || size == 2;
+            case Kind::INTEGER32:
+                return size == 1 || size == 2 || size == 4;
+            case Kind::INTEGER64:
+                return size == 1 || size == 2 || size == 4 || size == 8;
+            case Kind::STRING:
+            case Kind::BYTES:
+                return true;
+        }
+
+        return false;
+    }
+
+    const radius_lite::PacketView& throwOnError(radius_lite::Error error, const radius_lite::PacketView& view)
+    {
+        if (error != radius_lite::Error::success)
+            throw radius_lite::Exception(error);
+
+        return view;
+    }
+
+    // Response Authenticator = MD5(Code + Identifier + Length + Request Authenticator + Attributes + Secret),
+    // hashed in place over the encoded packet and the secret, the result is written into the header
+    void calcResponseAuth(
+        uint8_t* buffer,
+        size_t length,
+        const std::array<uint8_t, 16>& requestAuth,
+        const radius_lite::SecretContext& secret)
+    {
+        MD5_CTX context;
+        MD5_Init(&context);
+        MD5_Update(&context, buffer, 4);
+        MD5_Update(&context, requestAuth.data(), requestAuth.size());
+        MD5_Update(&context, buffer + 20, length - 20);
+        MD5_Update(&context, secret.secret().data(), secret.secret().length());
+        MD5_Final(buffer + 4, &context);
+    }
 }
 
 Packet::Packet(
   const uint8_t* buffer,
   size_t size,
-  const std::string& secret)
-  : m_recalcAuth(false)
+  const radius_lite::SecretContext& secret,
+  PacketArenaPtr arena,
+  const radius_lite::AttributeDecodeTable& decodeTable)
+  : Packet(PacketView(buffer, size), secret, std::move(arena), decodeTable)
+{}
+
+Packet::Packet(
+  const PacketView& view,
+  const radius_lite::SecretContext& secret,
+  PacketArenaPtr arena,
+  const radius_lite::AttributeDecodeTable& decodeTable)
+  : Packet(throwOnError(check_(view, secret, decodeTable), view), secret, std::move(arena), decodeTable, Checked())
+{}
+
+std::optional<Packet> Packet::parse(
+  const uint8_t* buffer,
+  size_t size,
+  const radius_lite::SecretContext& secret,
+  boost::system::error_code& ec,
+  PacketArenaPtr arena,
+  const radius_lite::AttributeDecodeTable& decodeTable)
 {
-  /*
-  std::cout << "===================" << std::endl;
-  std::cout << std::hex << std::setfill('0') << std::setw(2);
+  const auto view = PacketView::parse(buffer, size, ec);
+  if (!view)
+    return std::nullopt;
 
-  for (unsigned int i = 0; i < size; ++i)
+  return parse(*view, secret, ec, std::move(arena), decodeTable);
+}
+
+std::optional<Packet> Packet::parse(
+  const PacketView& view,
+  const radius_lite::SecretContext& secret,
+  boost::system::error_code& ec,
+  PacketArenaPtr arena,
+  const radius_lite::AttributeDecodeTable& decodeTable)
+{
+  const radius_lite::Error error = check_(view, secret, decodeTable);
+  if (error != radius_lite::Error::success)
   {
-    if (i % 16 == 0)
-    {
-      std::cout << std::endl;
-    }
-    std::cout << static_cast<unsigned int>(buffer[i]) << " ";
+    ec = error;
+    return std::nullopt;
   }
 
-  std::cout << std::dec;
-  std::cout << "===================" << std::endl;
-  */
-
-  if (size < 20)
-      throw Exception(Error::numberOfBytesIsLessThan20);
+  ec.clear();
+  return Packet(view, secret, std::move(arena), decodeTable, Checked());
+}
 
-  size_t length = buffer[2] * 256 + buffer[3];
+radius_lite::Error Packet::check_(
+  const PacketView& view,
+  const radius_lite::SecretContext& secret,
+  const radius_lite::AttributeDecodeTable& decodeTable)
+{
+  using radius_lite::Error;
 
-  if (size < length)
-      throw Exception(Error::requestLengthIsShort);
+  const uint8_t type = view.type();
 
-  m_type = buffer[0];
+  // responses are signed with the authenticator of the request that isn't known here,
+  // they should be checked with PacketView::check_message_authenticator
+  if (view.has_message_authenticator() &&
+    (type == ACCESS_REQUEST || type == STATUS_SERVER || type == ACCOUNTING_REQUEST))
+  {
+    // accounting request authenticator is a digest of the packet itself, zeros are used instead
+    const Auth requestAuth = type == ACCOUNTING_REQUEST ? Auth{} : view.auth();
 
-  m_id = buffer[1];
+    if (!view.check_message_authenticator(secret, requestAuth))
+      return Error::invalidMessageAuthenticator;
+  }
 
-  for (std::size_t i = 0; i < m_auth.size(); ++i)
+  // Vendor-Specific framing is checked by PacketView
+  for (const auto& attribute : view)
   {
-    m_auth[i] = buffer[i + 4];
+    if (attribute.type != VENDOR_SPECIFIC &&
+      !validAttributeSize(decodeTable.kind(attribute.type), attribute.value.size()))
+      return Error::invalidAttributeSize;
   }
 
-  size_t attributeIndex = 20;
-  while (attributeIndex < length)
-  {
-    const uint8_t attributeType = buffer[attributeIndex];
-    const uint8_t attributeLength = buffer[attributeIndex + 1];
+  return Error::success;
+}
 
-    if (attributeType == VENDOR_SPECIFIC)
+Packet::Packet(
+  const PacketView& view,
+  const radius_lite::SecretContext& secret,
+  PacketArenaPtr arena,
+  const radius_lite::AttributeDecodeTable& decodeTable,
+  Checked)
+  : m_arena(std::move(arena)),
+    m_type(view.type()),
+    m_id(view.id()),
+    m_recalcAuth(false),
+    m_auth(view.auth()),
+    m_index(m_arena ? m_arena.get() : std::pmr::get_default_resource())
+{
+  std::pmr::memory_resource* resource = m_arena ? m_arena.get() : std::pmr::get_default_resource();
+
+  m_attributes.reserve(view.attributes_count());
+  m_vendorSpecific.reserve(view.vendor_attributes_count());
+
+  // attributes decoded before an exception are released by their holders
+  for (const auto& attribute : view)
+  {
+    if (attribute.type == VENDOR_SPECIFIC)
     {
-      m_vendorSpecific.emplace_back(VendorSpecific(&buffer[attributeIndex + 2]));
+      m_vendorSpecific.emplace_back(VendorSpecific(attribute.value.data(), resource));
     }
     else
     {
-        m_attributes.push_back(
-          makeAttribute(
-            attributeType,
-            &buffer[attributeIndex + 2],
-            attributeLength - 2,
-            secret,
-            m_auth));
+      m_attributes.push_back(
+        makeAttribute(
+          attribute.type,
+          attribute.value.data(),
+          attribute.value.size(),
+          secret,
+          m_auth,
+          decodeTable,
+          m_arena.get()));
     }
-
-    attributeIndex += attributeLength;
-  }
-
-  bool eapMessage = false;
-  bool messageAuthenticator = false;
-
-  for (const auto& a : m_attributes)
-  {
-      if (a->type() == EAP_MESSAGE)
-          eapMessage = true;
-
-      if (a->type() == MESSAGE_AUTHENTICATOR)
-          messageAuthenticator = true;
   }
 
-  if (eapMessage && !messageAuthenticator)
-      throw Exception(Error::eapMessageAttributeError);
+  m_index.build(m_attributes, m_vendorSpecific);
 }
 
 Packet::Packet(uint8_t type, uint8_t id, const std::vector<Attribute*>& attributes,
@@ -121,9 +251,10 @@ Packet::Packet(uint8_t type, uint8_t id, const std::vector<Attribute*>& attribut
       m_id(id),
       m_recalcAuth(true),
       m_auth{}, // fill auth with zeros
-      m_attributes(attributes),
+      m_attributes(adopt_(attributes)),
       m_vendorSpecific(vendorSpecific)
 {
+    m_index.build(m_attributes, m_vendorSpecific);
 }
 
 Packet::Packet(uint8_t type, uint8_t id, const std::array<uint8_t, 16>& auth, const std::vector<Attribute*>& attributes,
@@ -133,9 +264,10 @@ Packet::Packet(uint8_t type, uint8_t id, const std::array<uint8_t, 16>& auth, co
       m_id(id),
       m_recalcAuth(m_type == 2 || recalc_auth),
       m_auth(auth),
-      m_attributes(attributes),
+      m_attributes(adopt_(attributes)),
       m_vendorSpecific(vendorSpecific)
 {
+    m_index.build(m_attributes, m_vendorSpecific);
 }
 
 Packet::Packet(const Packet& other)
@@ -146,64 +278,111 @@ Packet::Packet(const Packet& other)
       m_vendorSpecific(other.m_vendorSpecific)
 
 {
-  for (const auto& a :  other.m_attributes)
+  m_attributes.reserve(other.m_attributes.size());
+
+  for (const auto& a : other.m_attributes)
   {
     if (a)
     {
-      m_attributes.push_back(a->clone());
+      m_attributes.emplace_back(a->clone());
     }
   }
+
+  m_index.build(m_attributes, m_vendorSpecific);
+}
+
+std::vector<radius_lite::AttributeHolder> Packet::adopt_(const std::vector<Attribute*>& attributes)
+{
+    std::vector<AttributeHolder> result;
+    result.reserve(attributes.size());
+
+    for (const auto& attribute : attributes)
+        result.emplace_back(attribute);
+
+    return result;
 }
 
-Packet::~Packet()
+void Packet::addMessageAuthenticator()
 {
-    for (const auto& ap : m_attributes)
-        delete ap;
+    if (find_attribute(MESSAGE_AUTHENTICATOR))
+        return;
+
+    // value is filled in by encode
+    const std::array<uint8_t, 16> zeros{};
+    std::pmr::memory_resource* resource = m_arena ? m_arena.get() : std::pmr::get_default_resource();
+    m_attributes.push_back(createAttribute<Bytes>(m_arena.get(), MESSAGE_AUTHENTICATOR, zeros.data(), zeros.size(), resource));
+    m_index.build(m_attributes, m_vendorSpecific);
 }
 
-const std::vector<uint8_t> Packet::makeSendBuffer(const std::string& secret) const
+const radius_lite::Attribute* Packet::find_attribute(uint8_t type) const
 {
-    std::vector<uint8_t> sendBuffer(20);
+    const size_t position = m_index.first(type);
+    return position != AttributeIndex::npos ? m_attributes[position].get() : nullptr;
+}
 
-    sendBuffer[0] = m_type;
-    sendBuffer[1] = m_id;
+const radius_lite::VendorSpecific* Packet::find_vendor_attribute(uint32_t vendor_id, uint8_t vendor_type) const
+{
+    const auto range = m_index.vendor(vendor_id, vendor_type);
+    return !range.empty() ? &m_vendorSpecific[range.begin()->position] : nullptr;
+}
 
-    for (size_t i = 0; i < m_auth.size(); ++i)
-    {
-        sendBuffer[i + 4] = m_auth[i];
-    }
+const std::vector<uint8_t> Packet::makeSendBuffer(const SecretContext& secret) const
+{
+    std::vector<uint8_t> sendBuffer(encoded_size());
+    encode(sendBuffer.data(), sendBuffer.size(), secret);
+    return sendBuffer;
+}
+
+size_t Packet::encoded_size() const
+{
+    size_t size = 20;
 
     for (const auto& attribute : m_attributes)
-    {
-        const auto aData = attribute->toVector(secret, m_auth);
-        sendBuffer.insert(sendBuffer.end(), aData.begin(), aData.end());
-    }
+        size += attribute->encoded_size();
 
     for (const auto& vendorAttribute : m_vendorSpecific)
+        size += vendorAttribute.encoded_size();
+
+    return size;
+}
+
+size_t Packet::encode(uint8_t* buffer, size_t size, const SecretContext& secret) const
+{
+    const size_t length = encoded_size();
+
+    if (size < length)
+        throw radius_lite::Exception(radius_lite::Error::sendBufferIsTooSmall);
+
+    buffer[0] = m_type;
+    buffer[1] = m_id;
+    buffer[2] = length / 256 % 256;
+    buffer[3] = length % 256;
+
+    for (size_t i = 0; i < m_auth.size(); ++i)
     {
-        const auto aData = vendorAttribute.toVector();
-        sendBuffer.insert(sendBuffer.end(), aData.begin(), aData.end());
+        buffer[i + 4] = m_auth[i];
     }
 
-    sendBuffer[2] = sendBuffer.size() / 256 % 256;
-    sendBuffer[3] = sendBuffer.size() % 256;
+    size_t pos = 20;
+    size_t messageAuthenticatorOffset = 0;
 
-    if (m_recalcAuth)
+    for (const auto& attribute : m_attributes)
     {
-        sendBuffer.resize(sendBuffer.size() + secret.length());
+        if (attribute->type() == MESSAGE_AUTHENTICATOR && attribute->encoded_size() == 18 && !messageAuthenticatorOffset)
+            messageAuthenticatorOffset = pos + 2;
 
-        for (size_t i = 0; i < secret.length(); ++i)
-        {
-            sendBuffer[i + sendBuffer.size() - secret.length()] = secret[i];
-        }
+        pos += attribute->encode(buffer + pos, secret, m_auth);
+    }
 
-        std::array<uint8_t, 16> md;
-        MD5(sendBuffer.data(), sendBuffer.size(), md.data());
+    for (const auto& vendorAttribute : m_vendorSpecific)
+        pos += vendorAttribute.encode(buffer + pos);
 
-        sendBuffer.resize(sendBuffer.size() - secret.length());
+    // Message-Authenticator is signed first, Response Authenticator covers its value
+    if (messageAuthenticatorOffset)
+        calcMessageAuthenticator(secret, buffer, length, messageAuthenticatorOffset, m_auth, buffer + messageAuthenticatorOffset);
 
-        for (size_t i = 0; i < md.size(); ++i)
-            sendBuffer[i + 4] = md[i];
-    }
-    return sendBuffer;
+    if (m_recalcAuth)
+        calcResponseAuth(buffer, length, m_auth, secret);
+
+    return length;
 }
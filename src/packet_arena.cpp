@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "packet_arena.h"
+#include "owner_pool.h"
+
+namespace radius_lite
+{
+  template<>
+  const size_t OwnerPool<PacketArena>::MAX_POOLED = 64;
+
+  void PacketArena::Releaser::operator()(PacketArena* arena) const
+  {
+    arena->reset();
+    OwnerPool<PacketArena>::release(arena);
+  }
+
+  PacketArena::PacketArena(size_t chunk_size)
+    : chunk_size_(chunk_size),
+      current_chunk_(0),
+      offset_(0),
+      owner_pool_(nullptr),
+      owner_pool_next_(nullptr)
+  {}
+
+  PacketArena::Ptr PacketArena::acquire()
+  {
+    PacketArena* arena = OwnerPool<PacketArena>::acquire();
+    if (arena)
+    {
+      return Ptr(arena);
+    }
+
+    return Ptr(OwnerPool<PacketArena>::adopt(new PacketArena()));
+  }
+
+  void PacketArena::reset()
+  {
+    current_chunk_ = 0;
+    offset_ = 0;
+  }
+
+  void* PacketArena::do_allocate(size_t bytes, size_t alignment)
+  {
+    while (current_chunk_ < chunks_.size())
+    {
+      Chunk& chunk = chunks_[current_chunk_];
+      const size_t aligned_offset = (offset_ + alignment - 1) / alignment * alignment;
+      if (aligned_offset + bytes <= chunk.size)
+      {
+        offset_ = aligned_offset + bytes;
+        return chunk.data.get() + aligned_offset;
+      }
+
+      ++current_chunk_;
+      offset_ = 0;
+    }
+
+    // chunk data is aligned for any fundamental type, so bigger alignments are not supported
+    const size_t size = std::max(chunk_size_, bytes);
+    chunks_.push_back(Chunk{std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+    current_chunk_ = chunks_.size() - 1;
+    offset_ = bytes;
+    return chunks_.back().data.get();
+  }
+
+  void PacketArena::do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/)
+  {}
+
+  bool PacketArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+  {
+    return this == &other;
+  }
+}
@@ -0,0 +1,25 @@
+#include "packet_buffer.h"
+#include "owner_pool.h"
+
+namespace radius_lite
+{
+  template<>
+  const size_t OwnerPool<PacketBuffer>::MAX_POOLED = 512;
+
+  PacketBufferPtr PacketBuffer::acquire()
+  {
+    PacketBuffer* buffer = OwnerPool<PacketBuffer>::acquire();
+    if (buffer)
+    {
+      return PacketBufferPtr(buffer);
+    }
+
+    return PacketBufferPtr(OwnerPool<PacketBuffer>::adopt(new PacketBuffer()));
+  }
+
+  void PacketBuffer::release_(PacketBuffer* buffer)
+  {
+    buffer->size_ = 0;
+    OwnerPool<PacketBuffer>::release(buffer);
+  }
+}
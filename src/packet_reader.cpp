@@ -1,46 +1,43 @@
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 
 #include "packet_reader.h"
 #include "type_decoder.h"
+#include "attribute_types.h"
+#include "utils.h"
 
 namespace radius_lite
 {
   PacketReader::PacketReader(
     const Packet& packet,
-    const Dictionaries& dictionaries,
-    std::string secret)
+    const DictionaryLookup& dictionaries,
+    SecretContext secret)
     : packet_(packet),
       dictionaries_(dictionaries),
       secret_(std::move(secret))
   {}
 
+  PacketReader::PacketReader(
+    const Packet& packet,
+    std::shared_ptr<const DictionaryLookup> dictionaries,
+    SecretContext secret)
+    : packet_(packet),
+      snapshot_(std::move(dictionaries)),
+      dictionaries_(*snapshot_),
+      secret_(std::move(secret))
+  {}
+
   ConstAttributePtr
   PacketReader::get_attribute_by_name(const std::string& name) const
   {
-    for (const auto& attribute : packet_.attributes())
+    const auto attribute_id = dictionaries_.find_attribute_code(name);
+    if (!attribute_id)
     {
-      auto attribute_id = attribute->type();
-      //std::cout << "A: " << dictionaries_.attributeName(attribute_id) << std::endl;
-
-      if (dictionaries_.attributeName(attribute_id) == name)
-      {
-        auto attribute_type = dictionaries_.get_attribute_type(attribute_id);
-        //std::cout << "ATYPE: " << (attribute_type.has_value() ? *attribute_type : std::string("unknown")) << std::endl;
-        if (attribute_type.has_value())
-        {
-          auto plain_value = attribute->data(secret_, packet_.auth());
-          return TypeDecoder::instance().decode(
-            attribute_id,
-            *attribute_type,
-            plain_value.data(),
-            plain_value.size(),
-            secret_,
-            packet_.auth());
-        }
-      }
+      return ConstAttributePtr();
     }
 
-    return ConstAttributePtr();
+    return get_attribute(AttributeKey(static_cast<uint8_t>(*attribute_id)));
   }
 
   ConstAttributePtr
@@ -48,31 +45,13 @@ namespace radius_lite
   {
     if (!vendor_name.empty())
     {
-      auto vendor_id = dictionaries_.vendorNames().code(vendor_name);
-      auto vendor_attr_id = dictionaries_.vendorAttributes().code(std::string(vendor_name), name);
-
-      for (const auto& attribute : packet_.vendorSpecific())
+      const auto attribute_key = dictionaries_.get_attribute_key(name, vendor_name);
+      if (!attribute_key)
       {
-        if (attribute.vendorId() == vendor_id &&
-          attribute.vendorType() == vendor_attr_id)
-        {
-          auto attribute_type = dictionaries_.get_attribute_type(vendor_attr_id, vendor_id);
-          //std::cout << "ATYPE: " << (attribute_type.has_value() ? *attribute_type : std::string("unknown")) << std::endl;
-          if (attribute_type.has_value())
-          {
-            const auto plain_value = attribute.data();
-            return TypeDecoder::instance().decode(
-              vendor_attr_id,
-              *attribute_type,
-              plain_value.data(),
-              plain_value.size(),
-              secret_,
-              packet_.auth());
-          }
-        }
+        return ConstAttributePtr();
       }
 
-      return ConstAttributePtr();
+      return get_attribute(*attribute_key);
     }
     else
     {
@@ -81,58 +60,159 @@ namespace radius_lite
   }
 
   ConstAttributePtr
-  PacketReader::get_attribute(const Dictionaries::AttributeKey& attribute_key) const
+  PacketReader::get_attribute(const AttributeKey& attribute_key) const
   {
     if (attribute_key.vendor_id != 0)
     {
-      for (const auto& attribute : packet_.vendorSpecific())
+      const auto range = packet_.index().vendor(attribute_key.vendor_id, attribute_key.code);
+      if (!range.empty())
       {
-        if (attribute.vendorId() == attribute_key.vendor_id &&
-          attribute.vendorType() == attribute_key.code)
+        return decode_(packet_.vendorSpecific()[range.begin()->position]);
+      }
+    }
+    else
+    {
+      const size_t position = packet_.index().first(attribute_key.code);
+      if (position != AttributeIndex::npos)
+      {
+        return decode_(*packet_.attributes()[position]);
+      }
+    }
+
+    return ConstAttributePtr();
+  }
+
+  std::vector<ConstAttributePtr>
+  PacketReader::get_attributes(const AttributeKey& attribute_key) const
+  {
+    std::vector<ConstAttributePtr> result;
+
+    if (attribute_key.vendor_id != 0)
+    {
+      for (const auto& entry : packet_.index().vendor(attribute_key.vendor_id, attribute_key.code))
+      {
+        auto attribute = decode_(packet_.vendorSpecific()[entry.position]);
+        if (attribute)
         {
-          auto attribute_type = dictionaries_.get_attribute_type(
-            attribute_key.code,
-            attribute_key.vendor_id);
-
-          if (attribute_type.has_value())
-          {
-            const auto plain_value = attribute.data();
-            return TypeDecoder::instance().decode(
-              attribute_key.code,
-              *attribute_type,
-              plain_value.data(),
-              plain_value.size(),
-              secret_,
-              packet_.auth());
-          }
+          result.push_back(std::move(attribute));
         }
       }
     }
     else
     {
-      for (const auto& attribute : packet_.attributes())
+      for (size_t position = packet_.index().first(attribute_key.code);
+        position != AttributeIndex::npos;
+        position = packet_.index().next(position))
       {
-        auto attribute_id = attribute->type();
-
-        if (attribute_id == attribute_key.code)
+        auto attribute = decode_(*packet_.attributes()[position]);
+        if (attribute)
         {
-          auto attribute_type = dictionaries_.get_attribute_type(attribute_id);
-
-          if (attribute_type.has_value())
-          {
-            auto plain_value = attribute->data(secret_, packet_.auth());
-            return TypeDecoder::instance().decode(
-              attribute_id,
-              *attribute_type,
-              plain_value.data(),
-              plain_value.size(),
-              secret_,
-              packet_.auth());
-          }
+          result.push_back(std::move(attribute));
         }
       }
     }
 
+    return result;
+  }
+
+  bool
+  PacketReader::check_password(std::string_view password) const
+  {
+    const auto* attribute = dynamic_cast<const Encrypted*>(packet_.find_attribute(USER_PASSWORD));
+    return attribute && attribute->password_equals(password.data(), password.size());
+  }
+
+  std::optional<uint64_t>
+  PacketReader::get_uint(const AttributeKey& attribute_key) const
+  {
+    if (attribute_key.vendor_id == 0)
+    {
+      const Attribute* attribute = packet_.find_attribute(attribute_key.code);
+      if (!attribute)
+      {
+        return std::nullopt;
+      }
+
+      // integers are kept decoded
+      const auto value = attribute->value_view();
+      return value ? readUint(*value) : attribute->as_uint();
+    }
+
+    const auto value = get_octets_view(attribute_key);
+    return value ? readUint(*value) : std::nullopt;
+  }
+
+  std::optional<std::array<uint8_t, 4>>
+  PacketReader::get_ipv4(const AttributeKey& attribute_key) const
+  {
+    const auto value = get_octets_view(attribute_key);
+    if (!value || value->size() != 4)
+    {
+      return std::nullopt;
+    }
+
+    return std::array<uint8_t, 4>{(*value)[0], (*value)[1], (*value)[2], (*value)[3]};
+  }
+
+  std::optional<std::string_view>
+  PacketReader::get_string_view(const AttributeKey& attribute_key) const
+  {
+    const auto value = get_octets_view(attribute_key);
+    if (!value)
+    {
+      return std::nullopt;
+    }
+
+    return std::string_view(reinterpret_cast<const char*>(value->data()), value->size());
+  }
+
+  std::optional<ByteSpan>
+  PacketReader::get_octets_view(const AttributeKey& attribute_key) const
+  {
+    if (attribute_key.vendor_id == 0)
+    {
+      const Attribute* attribute = packet_.find_attribute(attribute_key.code);
+      return attribute ? attribute->value_view() : std::nullopt;
+    }
+
+    const VendorSpecific* attribute = packet_.find_vendor_attribute(attribute_key.vendor_id, attribute_key.code);
+    return attribute ? std::optional<ByteSpan>(attribute->value()) : std::nullopt;
+  }
+
+  ConstAttributePtr
+  PacketReader::decode_(const Attribute& attribute) const
+  {
+    const auto attribute_type = dictionaries_.get_attribute_value_type(attribute.type());
+
+    if (attribute_type != AttributeValueType::NONE)
+    {
+      auto plain_value = attribute.data(secret_, packet_.auth());
+      return TypeDecoder::instance().decode(
+        attribute.type(),
+        attribute_type,
+        plain_value.data(),
+        plain_value.size());
+    }
+
+    return ConstAttributePtr();
+  }
+
+  ConstAttributePtr
+  PacketReader::decode_(const VendorSpecific& attribute) const
+  {
+    const auto attribute_type = dictionaries_.get_attribute_value_type(
+      attribute.vendorType(), attribute.vendorId());
+
+    if (attribute_type != AttributeValueType::NONE)
+    {
+      const auto plain_value = attribute.value();
+      return TypeDecoder::instance().decode(
+        attribute.vendorType(),
+        attribute_type,
+        plain_value.data(),
+        plain_value.size());
+    }
+
     return ConstAttributePtr();
   }
 }
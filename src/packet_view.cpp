@@ -0,0 +1,190 @@
+#include "packet_view.h"
+#include "error.h"
+#include "attribute_types.h"
+#include "utils.h"
+
+namespace radius_lite
+{
+  PacketView::PacketView(const uint8_t* buffer)
+    : buffer_(buffer),
+      length_(0),
+      attributes_count_(0),
+      vendor_attributes_count_(0),
+      message_authenticator_offset_(0)
+  {}
+
+  PacketView::PacketView(const uint8_t* buffer, size_t size)
+    : PacketView(buffer)
+  {
+    const Error error = check_(size);
+    if (error != Error::success)
+      throw Exception(error);
+  }
+
+  std::optional<PacketView>
+  PacketView::parse(const uint8_t* buffer, size_t size, boost::system::error_code& ec)
+  {
+    PacketView view(buffer);
+
+    const Error error = view.check_(size);
+    if (error != Error::success)
+    {
+      ec = error;
+      return std::nullopt;
+    }
+
+    ec.clear();
+    return view;
+  }
+
+  Error PacketView::check_(size_t size)
+  {
+    const uint8_t* buffer = buffer_;
+
+    if (size < 20)
+      return Error::numberOfBytesIsLessThan20;
+
+    length_ = buffer[2] * 256 + buffer[3];
+
+    if (size < length_)
+      return Error::requestLengthIsShort;
+
+    if (length_ < 20)
+      return Error::numberOfBytesIsLessThan20;
+
+    bool eapMessage = false;
+    bool messageAuthenticator = false;
+
+    size_t attributeIndex = 20;
+    while (attributeIndex < length_)
+    {
+      if (attributeIndex + 2 > length_)
+        return Error::invalidAttributeSize;
+
+      const uint8_t attributeType = buffer[attributeIndex];
+      const uint8_t attributeLength = buffer[attributeIndex + 1];
+
+      if (attributeLength < 2 || attributeIndex + attributeLength > length_)
+        return Error::invalidAttributeSize;
+
+      if (attributeType == VENDOR_SPECIFIC)
+      {
+        // vendor id (4 bytes), vendor type, vendor length
+        if (attributeLength < 8)
+          return Error::invalidAttributeSize;
+
+        if (buffer[attributeIndex + 2] != 0)
+          return Error::invalidVendorSpecificAttributeId;
+
+        const uint8_t vendorLength = buffer[attributeIndex + 7];
+
+        if (vendorLength < 2 || vendorLength + 4 > attributeLength - 2)
+          return Error::invalidAttributeSize;
+
+        ++vendor_attributes_count_;
+      }
+      else
+      {
+        if (attributeType == EAP_MESSAGE)
+          eapMessage = true;
+
+        if (attributeType == MESSAGE_AUTHENTICATOR)
+        {
+          if (attributeLength != 18)
+            return Error::invalidAttributeSize;
+
+          if (!messageAuthenticator)
+            message_authenticator_offset_ = attributeIndex + 2;
+
+          messageAuthenticator = true;
+        }
+
+        ++attributes_count_;
+      }
+
+      attributeIndex += attributeLength;
+    }
+
+    if (eapMessage && !messageAuthenticator)
+      return Error::eapMessageAttributeError;
+
+    return Error::success;
+  }
+
+  Auth PacketView::auth() const
+  {
+    Auth result;
+    for (std::size_t i = 0; i < result.size(); ++i)
+    {
+      result[i] = buffer_[i + 4];
+    }
+    return result;
+  }
+
+  std::optional<ByteSpan>
+  PacketView::find_attribute(uint8_t type) const
+  {
+    for (const auto& attribute : *this)
+    {
+      if (attribute.type == type)
+      {
+        return attribute.value;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<ByteSpan>
+  PacketView::find_vendor_attribute(uint32_t vendor_id, uint8_t vendor_type) const
+  {
+    for (const auto& attribute : *this)
+    {
+      if (attribute.type == VENDOR_SPECIFIC)
+      {
+        const auto vendor_attribute_view = vendor_attribute(attribute);
+        if (vendor_attribute_view.vendor_id == vendor_id &&
+          vendor_attribute_view.vendor_type == vendor_type)
+        {
+          return vendor_attribute_view.value;
+        }
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  bool
+  PacketView::check_message_authenticator(const SecretContext& secret, const Auth& request_auth) const
+  {
+    if (!has_message_authenticator())
+      return false;
+
+    std::array<uint8_t, 16> digest;
+    calcMessageAuthenticator(secret, buffer_, length_, message_authenticator_offset_, request_auth, digest.data());
+
+    // don't stop on the first mismatch
+    uint8_t diff = 0;
+    for (size_t i = 0; i < digest.size(); ++i)
+    {
+      diff |= digest[i] ^ buffer_[message_authenticator_offset_ + i];
+    }
+
+    return diff == 0;
+  }
+
+  PacketView::VendorAttributeView
+  PacketView::vendor_attribute(const AttributeView& attribute)
+  {
+    const uint8_t* data = attribute.value.data();
+
+    VendorAttributeView result;
+    result.vendor_id = (static_cast<uint32_t>(data[0]) << 24) |
+      (static_cast<uint32_t>(data[1]) << 16) |
+      (static_cast<uint32_t>(data[2]) << 8) |
+      static_cast<uint32_t>(data[3]);
+    result.vendor_type = data[4];
+    result.value = ByteSpan(data + 6, data[5] - 2);
+    return result;
+  }
+}
@@ -0,0 +1,62 @@
+#include "secret_context.h"
+
+#include <array>
+#include <cstring>
+
+namespace radius_lite
+{
+  SecretContext::SecretContext()
+    : SecretContext(std::string())
+  {}
+
+  SecretContext::SecretContext(std::string secret)
+    : secret_(std::move(secret))
+  {
+    MD5_Init(&md5_);
+    MD5_Update(&md5_, secret_.data(), secret_.length());
+
+    // RFC 2104: keys longer than the block are hashed first
+    std::array<uint8_t, 64> key{};
+
+    if (secret_.length() > key.size())
+    {
+      MD5(reinterpret_cast<const uint8_t*>(secret_.data()), secret_.length(), key.data());
+    }
+    else
+    {
+      std::memcpy(key.data(), secret_.data(), secret_.length());
+    }
+
+    std::array<uint8_t, 64> pad;
+
+    for (size_t i = 0; i < pad.size(); ++i)
+    {
+      pad[i] = key[i] ^ 0x36;
+    }
+
+    MD5_Init(&hmac_inner_);
+    MD5_Update(&hmac_inner_, pad.data(), pad.size());
+
+    for (size_t i = 0; i < pad.size(); ++i)
+    {
+      pad[i] = key[i] ^ 0x5c;
+    }
+
+    MD5_Init(&hmac_outer_);
+    MD5_Update(&hmac_outer_, pad.data(), pad.size());
+  }
+
+  void SecretContext::hmac_final(MD5_CTX& inner, uint8_t* digest) const
+  {
+    std::array<uint8_t, 16> inner_digest;
+    MD5_Final(inner_digest.data(), &inner);
+
+    MD5_CTX outer = hmac_outer_;
+    MD5_Update(&outer, inner_digest.data(), inner_digest.size());
+    MD5_Final(digest, &outer);
+  }
+
+  SecretContext::SecretContext(const char* secret)
+    : SecretContext(std::string(secret))
+  {}
+}
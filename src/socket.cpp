@@ -1,5 +1,9 @@
+#include <sys/socket.h>
+
+#include <cstring>
 #include <iostream>
 #include "socket.h"
+#include "io_uring_transport.h"
 #include "error.h"
 #include "packet_codes.h"
 
@@ -8,6 +12,17 @@ using boost::system::error_code;
 
 namespace pls = std::placeholders;
 
+namespace
+{
+#ifdef RADIUS_LITE_MMSG
+  // upper bound of one sendmmsg call (UIO_MAXIOV)
+  const size_t MAX_SEND_BATCH = 1024;
+#endif
+
+  // responses waiting for a writable socket
+  const size_t DEFAULT_SEND_QUEUE_LIMIT = 1024;
+}
+
 std::string packetTypeToString(int type)
 {
     switch (type)
@@ -28,91 +43,494 @@ namespace radius_lite
 {
   Socket::Socket(
     boost::asio::io_service& io_service,
-    const std::string& secret,
+    const SecretContext& secret,
     uint16_t port,
-    const std::function<void(const boost::system::error_code&, const std::optional<Packet>&, const udp::endpoint&)>& callback)
+    const PacketProcessFun& callback,
+    bool reuse_port,
+    Transport transport)
+    : Socket(ViewCallback_(), io_service, secret, port, decode_callback_(*this, callback), reuse_port, transport)
+  {}
+
+  Socket::Socket(
+    ViewCallback_,
+    boost::asio::io_service& io_service,
+    const SecretContext& secret,
+    uint16_t port,
+    PacketViewProcessFun callback,
+    bool reuse_port,
+    Transport transport)
     : io_service_(io_service),
-      socket_(io_service, udp::endpoint(udp::v4(), port)),
-      secret_(secret)
+      socket_(open_(io_service, port, reuse_port)),
+      secret_(secret),
+      decode_table_(&AttributeDecodeTable::standard()),
+      callback_(std::move(callback)),
+      received_data_(nullptr),
+      received_size_(0),
+      received_owner_(nullptr),
+      batch_size_(1),
+      flush_ordered_(false),
+      send_queue_limit_(DEFAULT_SEND_QUEUE_LIMIT),
+      send_drop_policy_(SendDropPolicy::DROP_NEWEST)
   {
     std::cout << "Socket: port = " << port << std::endl;
-    start_receive_loop_(callback);
+
+    if (transport == Transport::IO_URING)
+    {
+      io_uring_ = IoUringTransport::create(
+        io_service_,
+        socket_.native_handle(),
+        [this](const error_code& error, const uint8_t* buffer, std::size_t bytes, const udp::endpoint& source)
+        {
+          handle_receive_(error, buffer, bytes, source, nullptr);
+        },
+        io_stats_);
+
+      if (!io_uring_)
+      {
+        std::cerr << "Socket: io_uring isn't supported, asio transport is used" << std::endl;
+      }
+    }
+
+    start_receive_loop_();
   }
 
+  Socket::PacketViewProcessFun
+  Socket::decode_callback_(Socket& socket, const PacketProcessFun& callback)
+  {
+    // owning packet is decoded only for handlers that ask for it
+    return [&socket, callback](
+      const error_code& error,
+      const std::optional<PacketView>& view,
+      const udp::endpoint& source)
+    {
+      if (!view)
+      {
+        callback(error, std::nullopt, source);
+        return;
+      }
+
+      error_code parse_error;
+      auto packet = Packet::parse(
+        *view,
+        socket.secret_,
+        parse_error,
+        PacketArena::acquire(),
+        *socket.decode_table_);
+
+      if (!packet)
+      {
+        ++socket.io_stats_.parse_errors;
+        callback(parse_error, std::nullopt, source);
+        return;
+      }
+
+      callback(error, std::move(packet), source);
+    };
+  }
+
+  Socket::~Socket()
+  {}
+
   void Socket::asyncSend(
     const Packet& response,
     const udp::endpoint& destination,
     const std::function<void(const boost::system::error_code&)>& callback)
   {
-    const std::vector<uint8_t> vResponse = response.makeSendBuffer(secret_);
+    PacketBufferPtr datagram = PacketBuffer::acquire();
+    datagram->resize(response.encode(datagram->data(), PacketBuffer::CAPACITY, secret_));
+    asyncSend(std::move(datagram), destination, callback);
+  }
 
-    io_service_.post(
-      [this, destination, callback, vResponse = std::move(vResponse)]
-      {
-        socket_.async_send_to(
-          boost::asio::buffer(vResponse),
-          destination,
-          [this, callback](const error_code& ec, std::size_t /*bytesTransferred*/)
-          {
-            handle_send_(ec, callback);
-          }
-        );
-      }
-    );
+  void Socket::asyncSend(
+    PacketBufferPtr datagram,
+    const udp::endpoint& destination,
+    const std::function<void(const boost::system::error_code&)>& callback)
+  {
+    if (io_uring_)
+    {
+      io_service_.post(
+        [this, destination, callback, datagram = std::move(datagram)]() mutable
+        {
+          io_uring_->send(std::move(datagram), destination, callback);
+        }
+      );
+      return;
+    }
+
+    if (!io_service_.get_executor().running_in_this_thread())
+    {
+      // other threads hand the datagram over to the io_service thread
+      io_service_.post(
+        [this, destination, callback, datagram = std::move(datagram)]() mutable
+        {
+          send_(std::move(datagram), destination, callback);
+        }
+      );
+      return;
+    }
+
+    send_(std::move(datagram), destination, callback);
+  }
+
+  PacketBufferPtr Socket::received_buffer() const
+  {
+    if (received_owner_)
+    {
+      return PacketBufferPtr(received_owner_);
+    }
+
+    if (!received_data_)
+    {
+      return PacketBufferPtr();
+    }
+
+    PacketBufferPtr copy = PacketBuffer::acquire();
+    std::memcpy(copy->data(), received_data_, received_size_);
+    copy->resize(received_size_);
+    return copy;
   }
 
-  void Socket::start_receive_loop_(const PacketProcessFun& callback)
+  udp::socket
+  Socket::open_(boost::asio::io_service& io_service, uint16_t port, bool reuse_port)
+  {
+    using ReusePort = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+    const udp::endpoint endpoint(udp::v4(), port);
+    udp::socket socket(io_service);
+    socket.open(endpoint.protocol());
+
+    if (reuse_port)
+    {
+      socket.set_option(ReusePort(true));
+    }
+
+    socket.bind(endpoint);
+
+    // send_to of asyncSend returns would_block instead of blocking, asio operations aren't affected
+    socket.non_blocking(true);
+    return socket;
+  }
+
+  void Socket::start_receive_loop_()
   {
     std::cout << "Socket: start_receive_loop_" << std::endl;
     io_service_.post(
-      [this, callback]
+      [this]
       {
-        order_receive_(callback);
+        if (io_uring_)
+        {
+          io_uring_->start();
+          return;
+        }
+
+        order_receive_();
       }
     );
   }
 
   void
-  Socket::order_receive_(const PacketProcessFun& callback)
+  Socket::order_receive_()
   {
-    std::cout << "Socket: order_receive_" << std::endl;
+#ifdef RADIUS_LITE_MMSG
+    if (batch_size_ > 1)
+    {
+      receive_batch_();
+      return;
+    }
+#endif
+
+    // the buffer is replaced only if the previous handler kept it
+    if (!recv_buffer_ || recv_buffer_->use_count() > 1)
+    {
+      recv_buffer_ = PacketBuffer::acquire();
+    }
+
     socket_.async_receive_from(
-      boost::asio::buffer(recv_buffer_),
+      boost::asio::buffer(recv_buffer_->data(), PacketBuffer::CAPACITY),
       remote_endpoint_,
-      [this, callback](const error_code& error, std::size_t bytes)
+      [this](const error_code& error, std::size_t bytes)
       {
-        handle_receive_(error, bytes, callback);
-        order_receive_(callback);
+        ++io_stats_.receive_calls;
+        recv_buffer_->resize(bytes);
+        handle_receive_(error, recv_buffer_->data(), bytes, remote_endpoint_, recv_buffer_.get());
+        order_receive_();
       });
   }
 
+#ifdef RADIUS_LITE_MMSG
+  void Socket::receive_batch_()
+  {
+    if (batch_messages_.size() != batch_size_)
+    {
+      batch_buffers_.resize(batch_size_);
+      batch_endpoints_.resize(batch_size_);
+      batch_iovecs_.resize(batch_size_);
+      batch_messages_.resize(batch_size_);
+
+      for (size_t i = 0; i < batch_size_; ++i)
+      {
+        batch_messages_[i] = mmsghdr();
+        batch_messages_[i].msg_hdr.msg_name = batch_endpoints_[i].data();
+        batch_messages_[i].msg_hdr.msg_iov = &batch_iovecs_[i];
+        batch_messages_[i].msg_hdr.msg_iovlen = 1;
+      }
+    }
+
+    for (size_t i = 0; i < batch_size_; ++i)
+    {
+      // buffers kept by handlers are replaced
+      if (!batch_buffers_[i] || batch_buffers_[i]->use_count() > 1)
+      {
+        batch_buffers_[i] = PacketBuffer::acquire();
+        batch_iovecs_[i].iov_base = batch_buffers_[i]->data();
+        batch_iovecs_[i].iov_len = PacketBuffer::CAPACITY;
+      }
+
+      // recvmmsg overwrites address lengths
+      batch_messages_[i].msg_hdr.msg_namelen = static_cast<socklen_t>(batch_endpoints_[i].capacity());
+    }
+
+    const int count = ::recvmmsg(
+      socket_.native_handle(),
+      batch_messages_.data(),
+      static_cast<unsigned int>(batch_size_),
+      MSG_DONTWAIT,
+      nullptr);
+    ++io_stats_.receive_calls;
+
+    const error_code receive_error = count < 0 ?
+      error_code(errno, boost::system::system_category()) : error_code();
+
+    if (receive_error && receive_error != boost::asio::error::would_block)
+    {
+      callback_(receive_error, std::nullopt, remote_endpoint_);
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+      batch_endpoints_[i].resize(batch_messages_[i].msg_hdr.msg_namelen);
+      batch_buffers_[i]->resize(batch_messages_[i].msg_len);
+      handle_receive_(
+        error_code(),
+        batch_buffers_[i]->data(),
+        batch_messages_[i].msg_len,
+        batch_endpoints_[i],
+        batch_buffers_[i].get());
+    }
+
+    if (count == static_cast<int>(batch_size_))
+    {
+      // more datagrams can be queued, read them after handlers posted by this batch
+      io_service_.post([this] { order_receive_(); });
+      return;
+    }
+
+    // socket is drained: the next datagram wakes the wait
+    socket_.async_wait(
+      udp::socket::wait_read,
+      [this](const error_code& error)
+      {
+        if (error)
+        {
+          callback_(error, std::nullopt, remote_endpoint_);
+        }
+
+        order_receive_();
+      });
+  }
+#endif
+
   void Socket::handle_receive_(
     const error_code& error,
+    const uint8_t* buffer,
     std::size_t bytes,
-    const std::function<void(const error_code&, const std::optional<Packet>&, const udp::endpoint&)>& callback)
+    const udp::endpoint& source,
+    PacketBuffer* owner)
   {
     if (error)
     {
-      callback(error, std::nullopt, remote_endpoint_);
+      callback_(error, std::nullopt, source);
+      return;
     }
 
-    if (bytes < 20)
+    ++io_stats_.received;
+
+    // malformed datagrams are reported without exceptions, floods of them stay cheap
+    error_code parse_error;
+    const auto view = PacketView::parse(buffer, bytes, parse_error);
+
+    if (!view)
     {
-      callback(Error::numberOfBytesIsLessThan20, std::nullopt, remote_endpoint_);
+      ++io_stats_.parse_errors;
     }
 
-    try
+    received_data_ = buffer;
+    received_size_ = bytes;
+    received_owner_ = owner;
+
+    callback_(parse_error, view, source);
+
+    received_data_ = nullptr;
+    received_size_ = 0;
+    received_owner_ = nullptr;
+  }
+
+  void Socket::send_(
+    PacketBufferPtr&& datagram,
+    const udp::endpoint& destination,
+    const std::function<void(const error_code&)>& callback)
+  {
+    // queued responses go first, batched mode always sends from the queue
+    if (batch_size_ > 1 || !send_queue_.empty())
     {
-      callback(
-        error,
-        std::make_optional<Packet>(recv_buffer_.data(), bytes, secret_),
-        remote_endpoint_);
+      enqueue_send_(std::move(datagram), destination, callback);
+      return;
     }
-    catch (const Exception& exception)
+
+    // the socket is non-blocking: a full send buffer returns would_block instead of waiting
+    error_code ec;
+    socket_.send_to(boost::asio::buffer(datagram->data(), datagram->size()), destination, 0, ec);
+    ++io_stats_.send_calls;
+
+    if (ec == boost::asio::error::would_block)
     {
-      std::cerr << "exception: " << exception.what() << std::endl;
-      callback(exception.getErrorCode(), std::nullopt, remote_endpoint_);
+      enqueue_send_(std::move(datagram), destination, callback);
+      return;
     }
+
+    // the buffer goes back to the pool before the callback, that can send the next response
+    datagram.reset();
+
+    io_stats_.sent += ec ? 0 : 1;
+    handle_send_(ec, callback);
+  }
+
+  void Socket::enqueue_send_(
+    PacketBufferPtr&& datagram,
+    const udp::endpoint& destination,
+    const std::function<void(const error_code&)>& callback)
+  {
+    if (send_queue_.size() >= send_queue_limit_)
+    {
+      ++io_stats_.send_dropped;
+
+      if (send_drop_policy_ == SendDropPolicy::DROP_NEWEST)
+      {
+        handle_send_(boost::asio::error::no_buffer_space, callback);
+        return;
+      }
+
+      PendingSend_ oldest = std::move(send_queue_.front());
+      send_queue_.pop_front();
+      handle_send_(boost::asio::error::no_buffer_space, oldest.callback);
+    }
+
+    send_queue_.push_back(PendingSend_{std::move(datagram), destination, callback});
+    ++io_stats_.send_queued;
+
+    if (!flush_ordered_)
+    {
+      flush_ordered_ = true;
+
+      if (batch_size_ > 1)
+      {
+        // responses of one receive batch are queued before the flush runs
+        io_service_.post([this] { flush_send_queue_(); });
+      }
+      else
+      {
+        wait_writable_();
+      }
+    }
+  }
+
+  void Socket::wait_writable_()
+  {
+    socket_.async_wait(
+      udp::socket::wait_write,
+      [this](const error_code& error)
+      {
+        if (error)
+        {
+          // socket is closed, report the error to every queued response
+          std::deque<PendingSend_> failed;
+          failed.swap(send_queue_);
+          flush_ordered_ = false;
+
+          for (const auto& pending : failed)
+          {
+            handle_send_(error, pending.callback);
+          }
+          return;
+        }
+
+        flush_send_queue_();
+      });
+  }
+
+  void Socket::flush_send_queue_()
+  {
+    while (!send_queue_.empty())
+    {
+#ifdef RADIUS_LITE_MMSG
+      const size_t size = std::min(send_queue_.size(), MAX_SEND_BATCH);
+      send_iovecs_.resize(size);
+      send_messages_.resize(size);
+
+      for (size_t i = 0; i < size; ++i)
+      {
+        PendingSend_& pending = send_queue_[i];
+        send_iovecs_[i].iov_base = pending.buffer->data();
+        send_iovecs_[i].iov_len = pending.buffer->size();
+        send_messages_[i] = mmsghdr();
+        send_messages_[i].msg_hdr.msg_name = pending.destination.data();
+        send_messages_[i].msg_hdr.msg_namelen = static_cast<socklen_t>(pending.destination.size());
+        send_messages_[i].msg_hdr.msg_iov = &send_iovecs_[i];
+        send_messages_[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      const int count = ::sendmmsg(
+        socket_.native_handle(),
+        send_messages_.data(),
+        static_cast<unsigned int>(size),
+        MSG_DONTWAIT);
+
+      const error_code ec = count < 0 ? error_code(errno, boost::system::system_category()) : error_code();
+#else
+      // without sendmmsg queued responses are sent one per call
+      error_code ec;
+      const PendingSend_& front = send_queue_.front();
+      socket_.send_to(boost::asio::buffer(front.buffer->data(), front.buffer->size()), front.destination, 0, ec);
+      const int count = ec ? -1 : 1;
+#endif
+      ++io_stats_.send_calls;
+
+      if (ec == boost::asio::error::would_block)
+      {
+        wait_writable_();
+        return;
+      }
+
+      // on error sendmmsg reports the first message only, others are retried
+      const size_t done = count < 0 ? 1 : static_cast<size_t>(count);
+      io_stats_.sent += count < 0 ? 0 : done;
+
+      // callbacks can queue new responses, completed ones are detached from the queue first
+      send_completed_.assign(
+        std::make_move_iterator(send_queue_.begin()),
+        std::make_move_iterator(send_queue_.begin() + done));
+      send_queue_.erase(send_queue_.begin(), send_queue_.begin() + done);
+
+      for (auto& pending : send_completed_)
+      {
+        pending.buffer.reset();
+        handle_send_(ec, pending.callback);
+      }
+
+      send_completed_.clear();
+    }
+
+    flush_ordered_ = false;
   }
 
   void Socket::handle_send_(const error_code& ec, const std::function<void(const error_code&)>& callback)
@@ -125,4 +543,29 @@ namespace radius_lite
     socket_.shutdown(udp::socket::shutdown_both, ec);
     socket_.close(ec);
   }
+
+  void Socket::set_decode_table(const AttributeDecodeTable& decode_table)
+  {
+    decode_table_ = &decode_table;
+  }
+
+  Socket::Transport Socket::transport() const
+  {
+    return io_uring_ ? Transport::IO_URING : Transport::ASIO;
+  }
+
+  void Socket::set_send_queue_limit(size_t limit, SendDropPolicy policy)
+  {
+    send_queue_limit_ = std::max<size_t>(limit, 1);
+    send_drop_policy_ = policy;
+  }
+
+  void Socket::set_batch_size(size_t batch_size)
+  {
+#ifdef RADIUS_LITE_MMSG
+    batch_size_ = std::max<size_t>(batch_size, 1);
+#else
+    (void)batch_size;
+#endif
+  }
 }
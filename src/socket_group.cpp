@@ -0,0 +1,195 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include <iostream>
+
+#include "socket_group.h"
+
+using boost::system::error_code;
+
+namespace radius_lite
+{
+  namespace
+  {
+    // shard of the thread running its io_service
+    thread_local const void* currentGroup = nullptr;
+    thread_local size_t currentShard = 0;
+  }
+
+  SocketGroup::SocketGroup(
+    const SecretContext& secret,
+    uint16_t port,
+    const Socket::PacketProcessFun& callback,
+    size_t shards_count,
+    bool pin_threads)
+  {
+    shards_count = std::max<size_t>(shards_count, 1);
+    shards_.reserve(shards_count);
+
+    // sockets are bound before threads start, so a bind error leaves nothing running
+    for (size_t i = 0; i < shards_count; ++i)
+    {
+      auto shard = std::make_unique<Shard>();
+      Shard* shard_ptr = shard.get();
+
+      shard->socket = std::make_unique<Socket>(
+        shard->io_service,
+        secret,
+        port,
+        [shard_ptr, callback](
+          const error_code& error,
+          std::optional<Packet>&& packet,
+          const boost::asio::ip::udp::endpoint& source)
+        {
+          if (error || !packet)
+          {
+            shard_ptr->errors.fetch_add(1, std::memory_order_relaxed);
+          }
+          else
+          {
+            shard_ptr->received.fetch_add(1, std::memory_order_relaxed);
+          }
+
+          callback(error, std::move(packet), source);
+        },
+        true);
+
+      shards_.push_back(std::move(shard));
+    }
+
+    try
+    {
+      for (size_t i = 0; i < shards_.size(); ++i)
+      {
+        shards_[i]->thread = std::thread([this, i, pin_threads]() { run_(i, pin_threads); });
+      }
+    }
+    catch (...)
+    {
+      // the destructor isn't called, started shards shouldn't outlive their sockets
+      join_();
+      throw;
+    }
+  }
+
+  SocketGroup::~SocketGroup()
+  {
+    join_();
+  }
+
+  void SocketGroup::join_()
+  {
+    stop();
+
+    for (auto& shard : shards_)
+    {
+      if (shard->thread.joinable())
+      {
+        shard->thread.join();
+      }
+    }
+  }
+
+  void SocketGroup::asyncSend(
+    const Packet& response,
+    const boost::asio::ip::udp::endpoint& destination,
+    const std::function<void(const error_code&)>& callback)
+  {
+    Shard& shard = current_shard_();
+    shard.sent.fetch_add(1, std::memory_order_relaxed);
+    shard.socket->asyncSend(response, destination, callback);
+  }
+
+  void SocketGroup::asyncSend(
+    PacketBufferPtr datagram,
+    const boost::asio::ip::udp::endpoint& destination,
+    const std::function<void(const error_code&)>& callback)
+  {
+    Shard& shard = current_shard_();
+    shard.sent.fetch_add(1, std::memory_order_relaxed);
+    shard.socket->asyncSend(std::move(datagram), destination, callback);
+  }
+
+  PacketBufferPtr SocketGroup::received_buffer() const
+  {
+    if (currentGroup != this)
+    {
+      return PacketBufferPtr();
+    }
+
+    return shards_[currentShard]->socket->received_buffer();
+  }
+
+  void SocketGroup::set_decode_table(const AttributeDecodeTable& decode_table)
+  {
+    for (auto& shard : shards_)
+    {
+      Socket* socket = shard->socket.get();
+      shard->io_service.post([socket, &decode_table]() { socket->set_decode_table(decode_table); });
+    }
+  }
+
+  void SocketGroup::set_batch_size(size_t batch_size)
+  {
+    for (auto& shard : shards_)
+    {
+      Socket* socket = shard->socket.get();
+      shard->io_service.post([socket, batch_size]() { socket->set_batch_size(batch_size); });
+    }
+  }
+
+  void SocketGroup::stop()
+  {
+    for (auto& shard : shards_)
+    {
+      shard->io_service.stop();
+    }
+  }
+
+  std::vector<SocketGroup::ShardStats> SocketGroup::stats() const
+  {
+    std::vector<ShardStats> result;
+    result.reserve(shards_.size());
+
+    for (const auto& shard : shards_)
+    {
+      ShardStats stats;
+      stats.received = shard->received.load(std::memory_order_relaxed);
+      stats.errors = shard->errors.load(std::memory_order_relaxed);
+      stats.sent = shard->sent.load(std::memory_order_relaxed);
+      result.push_back(stats);
+    }
+
+    return result;
+  }
+
+  void SocketGroup::run_(size_t index, bool pin_thread)
+  {
+    if (pin_thread)
+    {
+      const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(index % cpus, &cpu_set);
+
+      const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+      if (error != 0)
+      {
+        std::cerr << "SocketGroup: can't pin shard " << index << " to CPU " << index % cpus << std::endl;
+      }
+    }
+
+    currentGroup = this;
+    currentShard = index;
+
+    shards_[index]->io_service.run();
+
+    currentGroup = nullptr;
+  }
+
+  SocketGroup::Shard& SocketGroup::current_shard_()
+  {
+    return *shards_[currentGroup == this ? currentShard : 0];
+  }
+}
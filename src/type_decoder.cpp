@@ -3,73 +3,56 @@
 
 namespace radius_lite
 {
-  template<typename IntType>
-  std::function<radius_lite::AttributePtr(
-    unsigned int attribute_id,
-    const uint8_t* data,
-    size_t size,
-    const std::string& secret,
-    const std::array<uint8_t, 16>& auth)>
-  createIntegerDecodeFun()
+  namespace
   {
-    auto fun = [] (
-      unsigned int attribute_id,
-      const uint8_t* data,
-      size_t size,
-      const std::string&,
-      const std::array<uint8_t, 16>&)
+    // sizes are checked here, constructors throw on a size that NAS data can contain
+    template<typename IntType>
+    AttributePtr decodeInteger(unsigned int attribute_id, const uint8_t* data, size_t size)
     {
-      return std::make_shared<radius_lite::Integer<IntType>>(attribute_id, data, size);
-    };
-    return fun;
-  }
-
-  TypeDecoder::TypeDecoder()
-  {
-    base_type_decoders_.emplace(
-      "uint16",
-      createIntegerDecodeFun<uint16_t>()
-      );
-    base_type_decoders_.emplace(
-      "integer",
-      createIntegerDecodeFun<int32_t>()
-      );
-    base_type_decoders_.emplace(
-      "uint32",
-      createIntegerDecodeFun<uint32_t>()
-      );
-    base_type_decoders_.emplace(
-      "uint64",
-      createIntegerDecodeFun<uint64_t>()
-      );
-    base_type_decoders_.emplace(
-      "byte",
-      createIntegerDecodeFun<uint8_t>()
-      );
-    base_type_decoders_.emplace(
-      "string",
-      [] (
-        unsigned int attribute_id,
-        const uint8_t* data,
-        size_t size,
-        const std::string&,
-        const std::array<uint8_t, 16>&)
+      if (size != sizeof(IntType))
       {
-        return std::make_shared<radius_lite::String>(attribute_id, data, size);
+        return AttributePtr();
       }
-    );
-    base_type_decoders_.emplace(
-      "ipaddr",
-      [] (
-        unsigned int attribute_id,
-        const uint8_t* data,
-        size_t size,
-        const std::string&,
-        const std::array<uint8_t, 16>&)
+
+      return std::make_shared<Integer<IntType>>(attribute_id, data, size);
+    }
+
+    AttributePtr decodeString(unsigned int attribute_id, const uint8_t* data, size_t size)
+    {
+      return std::make_shared<String>(attribute_id, data, size);
+    }
+
+    AttributePtr decodeIpAddress(unsigned int attribute_id, const uint8_t* data, size_t size)
+    {
+      if (size != 4)
       {
-        return std::make_shared<radius_lite::IpAddress>(attribute_id, data, size);
+        return AttributePtr();
       }
-    );
+
+      return std::make_shared<IpAddress>(attribute_id, data, size);
+    }
+
+    AttributePtr decodeBytes(unsigned int attribute_id, const uint8_t* data, size_t size)
+    {
+      return std::make_shared<Bytes>(attribute_id, data, size);
+    }
+
+    size_t index(AttributeValueType type)
+    {
+      return static_cast<size_t>(type);
+    }
+  }
+
+  TypeDecoder::TypeDecoder()
+  {
+    base_type_decoders_.fill(decodeBytes);
+    base_type_decoders_[index(AttributeValueType::BYTE)] = decodeInteger<uint8_t>;
+    base_type_decoders_[index(AttributeValueType::UINT16)] = decodeInteger<uint16_t>;
+    base_type_decoders_[index(AttributeValueType::INTEGER)] = decodeInteger<int32_t>;
+    base_type_decoders_[index(AttributeValueType::UINT32)] = decodeInteger<uint32_t>;
+    base_type_decoders_[index(AttributeValueType::UINT64)] = decodeInteger<uint64_t>;
+    base_type_decoders_[index(AttributeValueType::STRING)] = decodeString;
+    base_type_decoders_[index(AttributeValueType::IPADDR)] = decodeIpAddress;
   }
 
   radius_lite::AttributePtr TypeDecoder::decode(
@@ -77,16 +60,19 @@ namespace radius_lite
     const std::string& type_name,
     const uint8_t* data,
     size_t size,
-    const std::string& secret,
-    const std::array<uint8_t, 16>& auth) const
+    const std::string& /*secret*/,
+    const std::array<uint8_t, 16>& /*auth*/) const
   {
-    auto decoder_it = base_type_decoders_.find(type_name);
-    if (decoder_it != base_type_decoders_.end())
-    {
-      return decoder_it->second(attribute_id, data, size, secret, auth);
-    }
+    return decode(attribute_id, attributeValueType(type_name), data, size);
+  }
 
-    return std::make_shared<radius_lite::Bytes>(attribute_id, data, size);
+  radius_lite::AttributePtr TypeDecoder::decode(
+    unsigned int attribute_id,
+    AttributeValueType type,
+    const uint8_t* data,
+    size_t size) const
+  {
+    return base_type_decoders_[index(type)](attribute_id, data, size);
   }
 
   const TypeDecoder&
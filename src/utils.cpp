@@ -1,5 +1,6 @@
 #include "utils.h"
 #include "attribute_types.h"
+#include <array>
 #include <cstdint> //uint8_t, uint32_t
 
 std::string radius_lite::byteToHex(uint8_t byte)
@@ -7,3 +8,38 @@ std::string radius_lite::byteToHex(uint8_t byte)
     static const std::string digits = "0123456789ABCDEF";
     return {digits[byte / 16], digits[byte % 16]};
 }
+
+std::optional<uint64_t> radius_lite::readUint(const ByteSpan& value)
+{
+    if (value.size() != 1 && value.size() != 2 && value.size() != 4 && value.size() != 8)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t result = 0;
+    for (const auto byte : value)
+    {
+        result = (result << 8) | byte;
+    }
+
+    return result;
+}
+
+void radius_lite::calcMessageAuthenticator(
+    const SecretContext& secret,
+    const uint8_t* packet,
+    size_t length,
+    size_t valueOffset,
+    const Auth& auth,
+    uint8_t* digest)
+{
+    static const std::array<uint8_t, 16> zeros{};
+
+    MD5_CTX context = secret.hmac_inner();
+    MD5_Update(&context, packet, 4);
+    MD5_Update(&context, auth.data(), auth.size());
+    MD5_Update(&context, packet + 20, valueOffset - 20);
+    MD5_Update(&context, zeros.data(), zeros.size());
+    MD5_Update(&context, packet + valueOffset + 16, length - valueOffset - 16);
+    secret.hmac_final(context, digest);
+}
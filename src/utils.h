@@ -1,9 +1,27 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
 #include <cstdint> //uint8_t, uint32_t
+#include <optional>
+
+#include "types.h"
+#include "secret_context.h"
 
 namespace radius_lite
 {
     std::string byteToHex(uint8_t byte);
+
+    // big-endian integer of 1, 2, 4 or 8 bytes
+    std::optional<uint64_t> readUint(const ByteSpan& value);
+
+    // RFC 3579 Message-Authenticator: HMAC-MD5 of the packet with auth in place of the header authenticator
+    // and zeros in place of the Message-Authenticator value that starts at valueOffset
+    void calcMessageAuthenticator(
+        const SecretContext& secret,
+        const uint8_t* packet,
+        size_t length,
+        size_t valueOffset,
+        const Auth& auth,
+        uint8_t* digest);
 }
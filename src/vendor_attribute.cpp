@@ -9,7 +9,8 @@ using VendorSpecific = radius_lite::VendorSpecific;
 
 namespace radius_lite
 {
-  VendorSpecific::VendorSpecific(const uint8_t* data)
+  VendorSpecific::VendorSpecific(const uint8_t* data, std::pmr::memory_resource* resource)
+    : m_value(resource)
   {
     if (data[0] != 0)
         throw radius_lite::Exception(radius_lite::Error::invalidVendorSpecificAttributeId);
@@ -22,40 +23,43 @@ namespace radius_lite
     m_vendorType = data[4];
 
     size_t vendorLength = data[5];
-    m_value.resize(vendorLength - 2);
-
-    for (size_t i = 0; i < vendorLength - 2; ++i)
-        m_value[i] = data[i + 6];
+    m_value.assign(data + 6, data + 6 + vendorLength - 2);
   }
 
   VendorSpecific::VendorSpecific(uint32_t vendorId, uint8_t vendorType, const std::vector<uint8_t>& vendorValue)
     : m_vendorId(vendorId),
       m_vendorType(vendorType),
-      m_value(vendorValue)
+      m_value(vendorValue.begin(), vendorValue.end())
   {
   }
 
-  const ByteArray& VendorSpecific::data() const
+  ByteArray VendorSpecific::data() const
   {
-    return m_value;
+    return ByteArray(m_value.begin(), m_value.end());
   }
 
   std::vector<uint8_t> VendorSpecific::toVector() const
   {
-    std::vector<uint8_t> attribute(m_value.size() + 8);
-    attribute[0] = VENDOR_SPECIFIC;
-    attribute[1] = m_value.size() + 8;
-    attribute[2] = m_vendorId / (1 << 24);
-    attribute[3] = (m_vendorId / (1 << 16)) % 256;
-    attribute[4] = (m_vendorId / (1 << 8)) % 256;
-    attribute[5] = m_vendorId % 256;
-    attribute[6] = vendorType();
-    attribute[7] = m_value.size() + 2;
-    for (size_t i = 0; i < m_value.size(); ++i)
-        attribute[i + 8] = m_value[i];
+    std::vector<uint8_t> attribute(encoded_size());
+    encode(attribute.data());
     return attribute;
   }
 
+  size_t VendorSpecific::encode(uint8_t* buffer) const
+  {
+    buffer[0] = VENDOR_SPECIFIC;
+    buffer[1] = m_value.size() + 8;
+    buffer[2] = m_vendorId / (1 << 24);
+    buffer[3] = (m_vendorId / (1 << 16)) % 256;
+    buffer[4] = (m_vendorId / (1 << 8)) % 256;
+    buffer[5] = m_vendorId % 256;
+    buffer[6] = vendorType();
+    buffer[7] = m_value.size() + 2;
+    for (size_t i = 0; i < m_value.size(); ++i)
+        buffer[i + 8] = m_value[i];
+    return m_value.size() + 8;
+  }
+
   std::string VendorSpecific::toString() const
   {
     std::string value;
@@ -18,6 +18,12 @@
 #include <boost/test/unit_test.hpp>
 #pragma GCC diagnostic pop
 
+namespace
+{
+  // built once: SecretContext hashes the secret on construction
+  const radius_lite::SecretContext secret("secret");
+}
+
 BOOST_AUTO_TEST_SUITE(attribute_tests)
 
 BOOST_AUTO_TEST_CASE(StringDataConstructor)
@@ -180,11 +186,11 @@ BOOST_AUTO_TEST_CASE(EncryptedDataConstructor_PasswordLength_6)
     0x92, 0xfa, 0xa1, 0xed, 0x98, 0x9b, 0xb4, 0x79, 0xfe, 0x20, 0xe2, 0xf4, 0x7f, 0x4a, 0x5a, 0x70};
   std::vector<uint8_t> d {
     0x25, 0x38, 0x58, 0x18, 0xae, 0x97, 0xeb, 0xeb, 0xbd, 0x46, 0xfd, 0xb9, 0xd1, 0x17, 0x84, 0xeb};
-  radius_lite::Encrypted s(2, d.data(), d.size(), "secret", auth);
+  radius_lite::Encrypted s(2, d.data(), d.size(), secret, auth);
 
   BOOST_CHECK_EQUAL(s.toString(), "123456");
 
-  std::vector<uint8_t> values = s.toVector("secret", auth);
+  std::vector<uint8_t> values = s.toVector(secret, auth);
   std::vector<uint8_t> expected(d);
   expected.insert(expected.begin(), 0x12);
   expected.insert(expected.begin(), 0x02);
@@ -194,6 +200,25 @@ BOOST_AUTO_TEST_CASE(EncryptedDataConstructor_PasswordLength_6)
   BOOST_CHECK_EQUAL(s.type(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(EncryptedPasswordEquals)
+{
+  std::array<uint8_t, 16> auth {
+    0x92, 0xfa, 0xa1, 0xed, 0x98, 0x9b, 0xb4, 0x79, 0xfe, 0x20, 0xe2, 0xf4, 0x7f, 0x4a, 0x5a, 0x70};
+  std::vector<uint8_t> d {
+    0x25, 0x38, 0x58, 0x18, 0xae, 0x97, 0xeb, 0xeb, 0xbd, 0x46, 0xfd, 0xb9, 0xd1, 0x17, 0x84, 0xeb};
+  radius_lite::Encrypted s(2, d.data(), d.size(), secret, auth);
+
+  // before and after the value is decrypted
+  BOOST_CHECK(s.password_equals("123456", 6));
+  BOOST_CHECK(!s.password_equals("123457", 6));
+  BOOST_CHECK(!s.password_equals("1234567", 7));
+
+  BOOST_CHECK_EQUAL(s.toString(), "123456");
+
+  BOOST_CHECK(s.password_equals("123456", 6));
+  BOOST_CHECK(!s.password_equals("12345", 5));
+}
+
 BOOST_AUTO_TEST_CASE(EncryptedDataConstructorThrow)
 {
   std::array<uint8_t, 16> auth {
@@ -209,7 +234,7 @@ BOOST_AUTO_TEST_CASE(EncryptedDataConstructorThrow)
     0x3b, 0x38, 0x5f, 0xeb, 0xe2, 0xd2, 0xa1, 0x5a, 0x1c, 0x97, 0x3d, 0xb9, 0x9b, 0xa1, 0x5f, 0xeb,
     0x2f
   };
-  BOOST_CHECK_THROW(radius_lite::Encrypted(2, d.data(), d.size(), "secret", auth), radius_lite::Exception);
+  BOOST_CHECK_THROW(radius_lite::Encrypted(2, d.data(), d.size(), secret, auth), radius_lite::Exception);
 }
 
 BOOST_AUTO_TEST_CASE(EncryptedDataConstructor1_PasswordLength_15)
@@ -218,11 +243,11 @@ BOOST_AUTO_TEST_CASE(EncryptedDataConstructor1_PasswordLength_15)
     0x40, 0x66, 0x42, 0xfc, 0x3e, 0xa4, 0x30, 0x4a, 0x42, 0x39, 0xdb, 0xb1, 0xf9, 0x8a, 0x09, 0x40};
   std::vector<uint8_t> d {
     0xf9, 0xe4, 0x4a, 0x32, 0x8a, 0xee, 0x19, 0x48, 0x64, 0x50, 0x70, 0x31, 0xf0, 0x92, 0x06, 0x05};
-  radius_lite::Encrypted s(2, d.data(), d.size(), "secret", auth);
+  radius_lite::Encrypted s(2, d.data(), d.size(), secret, auth);
 
   BOOST_CHECK_EQUAL(s.toString(), "123456789876543");
 
-  std::vector<uint8_t> values = s.toVector("secret", auth);
+  std::vector<uint8_t> values = s.toVector(secret, auth);
   std::vector<uint8_t> expected(d);
   expected.insert(expected.begin(), 0x12);
   expected.insert(expected.begin(), 0x02);
@@ -238,11 +263,11 @@ BOOST_AUTO_TEST_CASE(EncryptedDataConstructor_PasswordLength_16)
     0x9c, 0x8e, 0xef, 0xce, 0x5f, 0x18, 0xc7, 0x30, 0x04, 0xc3, 0x34, 0xee, 0x80, 0xfd, 0xf3, 0x98};
   std::vector<uint8_t> d {
     0x6a, 0xd8, 0x72, 0x2f, 0x87, 0x8a, 0xd5, 0x79, 0x0c, 0x30, 0xc3, 0xf6, 0x41, 0x70, 0xd6, 0x82};
-  radius_lite::Encrypted s(2, d.data(), d.size(), "secret", auth);
+  radius_lite::Encrypted s(2, d.data(), d.size(), secret, auth);
 
   BOOST_CHECK_EQUAL(s.toString(), "1234567898765432");
 
-  std::vector<uint8_t> values = s.toVector("secret", auth);
+  std::vector<uint8_t> values = s.toVector(secret, auth);
   std::vector<uint8_t> expected(d);
   expected.insert(expected.begin(), 0x12);
   expected.insert(expected.begin(), 0x02);
@@ -259,11 +284,11 @@ BOOST_AUTO_TEST_CASE(EncryptedDataConstructor_PasswordLength_17)
   std::vector<uint8_t> d {
     0x52, 0x8a, 0x79, 0x24, 0xf4, 0xa9, 0xc9, 0x04, 0x2b, 0x4a, 0xfe, 0x2f, 0x10, 0xd8, 0xa0, 0xcd,
     0x51, 0x99, 0xd3, 0xfd, 0xfb, 0xb0, 0xdc, 0x97, 0x6a, 0x19, 0xd6, 0xcc, 0x17, 0xfb, 0xff, 0x3b};
-  radius_lite::Encrypted s(2, d.data(), d.size(), "secret", auth);
+  radius_lite::Encrypted s(2, d.data(), d.size(), secret, auth);
 
   BOOST_CHECK_EQUAL(s.toString(), "12345678987654321");
 
-  std::vector<uint8_t> values = s.toVector("secret", auth);
+  std::vector<uint8_t> values = s.toVector(secret, auth);
   std::vector<uint8_t> expected(d);
   expected.insert(expected.begin(), 0x22);
   expected.insert(expected.begin(), 0x02);
@@ -281,7 +306,7 @@ BOOST_AUTO_TEST_CASE(EncryptedValueConstructor_PasswordLength_6)
 
   std::array<uint8_t, 16> auth {
     0x92, 0xfa, 0xa1, 0xed, 0x98, 0x9b, 0xb4, 0x79, 0xfe, 0x20, 0xe2, 0xf4, 0x7f, 0x4a, 0x5a, 0x70};
-  std::vector<uint8_t> values = v.toVector("secret", auth);
+  std::vector<uint8_t> values = v.toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x12, 0x25, 0x38, 0x58, 0x18, 0xae, 0x97, 0xeb, 0xeb, 0xbd, 0x46, 0xfd, 0xb9, 0xd1, 0x17,
     0x84, 0xeb};
@@ -299,7 +324,7 @@ BOOST_AUTO_TEST_CASE(EncryptedValueConstructor_PasswordLength_15)
 
   std::array<uint8_t, 16> auth {
     0x40, 0x66, 0x42, 0xfc, 0x3e, 0xa4, 0x30, 0x4a, 0x42, 0x39, 0xdb, 0xb1, 0xf9, 0x8a, 0x09, 0x40};
-  std::vector<uint8_t> values = v.toVector("secret", auth);
+  std::vector<uint8_t> values = v.toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x12, 0xf9, 0xe4, 0x4a, 0x32, 0x8a, 0xee, 0x19, 0x48, 0x64, 0x50, 0x70, 0x31, 0xf0, 0x92,
     0x06, 0x05};
@@ -317,7 +342,7 @@ BOOST_AUTO_TEST_CASE(EncryptedValueConstructor_PasswordLength_16)
 
   std::array<uint8_t, 16> auth {
     0x9c, 0x8e, 0xef, 0xce, 0x5f, 0x18, 0xc7, 0x30, 0x04, 0xc3, 0x34, 0xee, 0x80, 0xfd, 0xf3, 0x98};
-  std::vector<uint8_t> values = v.toVector("secret", auth);
+  std::vector<uint8_t> values = v.toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x12, 0x6a, 0xd8, 0x72, 0x2f, 0x87, 0x8a, 0xd5, 0x79, 0x0c, 0x30, 0xc3, 0xf6, 0x41, 0x70,
     0xd6, 0x82};
@@ -335,7 +360,7 @@ BOOST_AUTO_TEST_CASE(EncryptedValueConstructor_PasswordLength_17)
 
   std::array<uint8_t, 16> auth {
     0xf0, 0xcb, 0x8b, 0x5b, 0xd2, 0xd8, 0x96, 0x0b, 0xf7, 0x80, 0x68, 0x89, 0x27, 0x6a, 0xa4, 0xdc};
-  std::vector<uint8_t> values = v.toVector("secret", auth);
+  std::vector<uint8_t> values = v.toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x22, 0x52, 0x8a, 0x79, 0x24, 0xf4, 0xa9, 0xc9, 0x04, 0x2b, 0x4a, 0xfe, 0x2f, 0x10, 0xd8,
     0xa0, 0xcd, 0x51, 0x99, 0xd3, 0xfd, 0xfb, 0xb0, 0xdc, 0x97, 0x6a, 0x19, 0xd6, 0xcc, 0x17, 0xfb,
@@ -356,7 +381,7 @@ BOOST_AUTO_TEST_CASE(EncryptedClone_PasswordLength_6)
 
   std::array<uint8_t, 16> auth {
     0x92, 0xfa, 0xa1, 0xed, 0x98, 0x9b, 0xb4, 0x79, 0xfe, 0x20, 0xe2, 0xf4, 0x7f, 0x4a, 0x5a, 0x70};
-  std::vector<uint8_t> values = cs->toVector("secret", auth);
+  std::vector<uint8_t> values = cs->toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x12, 0x25, 0x38, 0x58, 0x18, 0xae, 0x97, 0xeb, 0xeb, 0xbd, 0x46, 0xfd, 0xb9, 0xd1, 0x17,
     0x84, 0xeb};
@@ -376,7 +401,7 @@ BOOST_AUTO_TEST_CASE(EncryptedClone_PasswordLength_15)
 
   std::array<uint8_t, 16> auth {
     0x40, 0x66, 0x42, 0xfc, 0x3e, 0xa4, 0x30, 0x4a, 0x42, 0x39, 0xdb, 0xb1, 0xf9, 0x8a, 0x09, 0x40};
-  std::vector<uint8_t> values = cs->toVector("secret", auth);
+  std::vector<uint8_t> values = cs->toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x12, 0xf9, 0xe4, 0x4a, 0x32, 0x8a, 0xee, 0x19, 0x48, 0x64, 0x50, 0x70, 0x31, 0xf0, 0x92,
     0x06, 0x05};
@@ -396,7 +421,7 @@ BOOST_AUTO_TEST_CASE(EncryptedClone_PasswordLength_16)
 
   std::array<uint8_t, 16> auth {
     0x9c, 0x8e, 0xef, 0xce, 0x5f, 0x18, 0xc7, 0x30, 0x04, 0xc3, 0x34, 0xee, 0x80, 0xfd, 0xf3, 0x98};
-  std::vector<uint8_t> values = cs->toVector("secret", auth);
+  std::vector<uint8_t> values = cs->toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x12, 0x6a, 0xd8, 0x72, 0x2f, 0x87, 0x8a, 0xd5, 0x79, 0x0c, 0x30, 0xc3, 0xf6, 0x41, 0x70,
     0xd6, 0x82};
@@ -416,7 +441,7 @@ BOOST_AUTO_TEST_CASE(EncryptedClone_PasswordLength_17)
 
   std::array<uint8_t, 16> auth {
     0xf0, 0xcb, 0x8b, 0x5b, 0xd2, 0xd8, 0x96, 0x0b, 0xf7, 0x80, 0x68, 0x89, 0x27, 0x6a, 0xa4, 0xdc};
-  std::vector<uint8_t> values = cs->toVector("secret", auth);
+  std::vector<uint8_t> values = cs->toVector(secret, auth);
   std::vector<uint8_t> expected {
     0x02, 0x22, 0x52, 0x8a, 0x79, 0x24, 0xf4, 0xa9, 0xc9, 0x04, 0x2b, 0x4a, 0xfe, 0x2f, 0x10, 0xd8,
     0xa0, 0xcd, 0x51, 0x99, 0xd3, 0xfd, 0xfb, 0xb0, 0xdc, 0x97, 0x6a, 0x19, 0xd6, 0xcc, 0x17, 0xfb,
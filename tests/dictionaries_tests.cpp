@@ -2,10 +2,15 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <cstdint>
 #include <stdexcept>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 
 #include <radius_lite/dictionaries.h>
+#include <radius_lite/frozen_dictionaries.h>
 #include <radius_lite/error.h>
 
 #pragma GCC diagnostic push
@@ -41,6 +46,35 @@ BOOST_AUTO_TEST_CASE(TestAdd)
   BOOST_CHECK_THROW(b.name(2), std::out_of_range);
 }
 
+BOOST_AUTO_TEST_CASE(TestFind)
+{
+  radius_lite::BasicDictionary b;
+
+  b.add(1, "User-Name");
+  b.add(3, "def");
+
+  BOOST_CHECK_EQUAL(*b.find_name(1), "User-Name");
+  BOOST_CHECK_EQUAL(*b.find_code("def"), 3);
+  BOOST_CHECK(!b.find_name(2));
+  BOOST_CHECK(!b.find_code("abc"));
+}
+
+BOOST_AUTO_TEST_CASE(TestAddRenamedCode)
+{
+  radius_lite::BasicDictionary b;
+
+  // code of "abc" in the reverse index is renamed, the name is free again
+  b.add(1, "abc");
+  b.add(1, "def");
+  b.add(2, "abc");
+  BOOST_CHECK_THROW(b.add(3, "abc"), radius_lite::Exception);
+  BOOST_CHECK_THROW(b.add(3, "def"), radius_lite::Exception);
+
+  BOOST_CHECK_EQUAL(b.name(1), "def");
+  BOOST_CHECK_EQUAL(b.name(2), "abc");
+  BOOST_CHECK_EQUAL(b.code("abc"), 1);
+}
+
 BOOST_AUTO_TEST_CASE(TestAppend)
 {
   radius_lite::BasicDictionary a;
@@ -215,6 +249,34 @@ BOOST_AUTO_TEST_CASE(test_add)
   BOOST_CHECK_THROW(b.name("Service-Type", 4), std::out_of_range);
 }
 
+BOOST_AUTO_TEST_CASE(TestFind)
+{
+  radius_lite::DependentDictionary b;
+
+  b.add(1, "Login-User", "Service-Type");
+  b.add(3, "def", "abc");
+
+  BOOST_CHECK_EQUAL(*b.find_name("Service-Type", 1), "Login-User");
+  BOOST_CHECK_EQUAL(*b.find_code("abc", "def"), 3);
+  BOOST_CHECK(!b.find_name("Service-Type", 3));
+  BOOST_CHECK(!b.find_name("abc", 1));
+  BOOST_CHECK(!b.find_code("Service-Type", "def"));
+}
+
+BOOST_AUTO_TEST_CASE(TestAddRenamedCode)
+{
+  radius_lite::DependentDictionary b;
+
+  b.add(1, "abc", "Service-Type");
+  b.add(1, "def", "Service-Type");
+  b.add(2, "abc", "Service-Type");
+  b.add(3, "abc", "Framed-Protocol");
+  BOOST_CHECK_THROW(b.add(3, "abc", "Service-Type"), radius_lite::Exception);
+
+  BOOST_CHECK_EQUAL(b.name("Service-Type", 2), "abc");
+  BOOST_CHECK_EQUAL(b.code("Service-Type", "abc"), 1);
+}
+
 BOOST_AUTO_TEST_CASE(TestAppend)
 {
   radius_lite::DependentDictionary a;
@@ -462,6 +524,26 @@ BOOST_AUTO_TEST_CASE(TestAppend)
   BOOST_CHECK_EQUAL(a.vendorAttributeValueCode("Dlink-User-Level", "User"), 3);
 }
 
+BOOST_AUTO_TEST_CASE(TestAttributeValueType)
+{
+  radius_lite::Dictionaries b("dictionary");
+  b.resolve();
+
+  BOOST_CHECK(b.get_attribute_value_type(1) == radius_lite::AttributeValueType::STRING);
+  BOOST_CHECK(b.get_attribute_value_type(2) == radius_lite::AttributeValueType::OCTETS);
+  BOOST_CHECK(b.get_attribute_value_type(6) == radius_lite::AttributeValueType::INTEGER);
+  BOOST_CHECK(b.get_attribute_value_type(5) == radius_lite::AttributeValueType::NONE);
+
+  BOOST_CHECK(b.get_attribute_value_type(1, 171) == radius_lite::AttributeValueType::INTEGER);
+  BOOST_CHECK(b.get_attribute_value_type(10, 171) == radius_lite::AttributeValueType::STRING);
+  BOOST_CHECK(b.get_attribute_value_type(2, 171) == radius_lite::AttributeValueType::NONE);
+  BOOST_CHECK(b.get_attribute_value_type(1, 172) == radius_lite::AttributeValueType::NONE);
+
+  BOOST_CHECK(radius_lite::attributeValueType("uint64") == radius_lite::AttributeValueType::UINT64);
+  BOOST_CHECK(radius_lite::attributeValueType("ipaddr") == radius_lite::AttributeValueType::IPADDR);
+  BOOST_CHECK(radius_lite::attributeValueType("abinary") == radius_lite::AttributeValueType::OCTETS);
+}
+
 BOOST_AUTO_TEST_CASE(TestConstructor)
 {
   radius_lite::Dictionaries b("dictionary");
@@ -482,6 +564,236 @@ BOOST_AUTO_TEST_CASE(TestConstructor)
   BOOST_CHECK_THROW(b.vendorAttributeValueCode("", ""), std::out_of_range);
 }
 
+BOOST_AUTO_TEST_CASE(TestFind)
+{
+  radius_lite::Dictionaries b("dictionary");
+
+  BOOST_CHECK_EQUAL(*b.find_attribute_name(1), "User-Name");
+  BOOST_CHECK_EQUAL(*b.find_attribute_code("User-Password"), 2);
+  BOOST_CHECK_EQUAL(*b.find_vendor_name(171), "Dlink");
+  BOOST_CHECK_EQUAL(*b.find_vendor_code("Dlink"), 171);
+  BOOST_CHECK_EQUAL(*b.find_vendor_attribute_name("Dlink", 10), "Dlink-VLAN-Name");
+  BOOST_CHECK_EQUAL(*b.find_vendor_attribute_code("Dlink", "Dlink-User-Level"), 1);
+  BOOST_CHECK_EQUAL(*b.find_attribute_value_name("Service-Type", 1), "Login-User");
+  BOOST_CHECK_EQUAL(*b.find_attribute_value_code("Service-Type", "Framed-User"), 2);
+  BOOST_CHECK_EQUAL(*b.find_vendor_attribute_value_name("Dlink-User-Level", 3), "User");
+  BOOST_CHECK_EQUAL(*b.find_vendor_attribute_value_code("Dlink-User-Level", "User-Legacy"), 1);
+
+  BOOST_CHECK(!b.find_attribute_name(0));
+  BOOST_CHECK(!b.find_attribute_code(""));
+  BOOST_CHECK(!b.find_vendor_name(0));
+  BOOST_CHECK(!b.find_vendor_code(""));
+  BOOST_CHECK(!b.find_vendor_attribute_name("", 0));
+  BOOST_CHECK(!b.find_vendor_attribute_code("", ""));
+  BOOST_CHECK(!b.find_attribute_value_name("", 0));
+  BOOST_CHECK(!b.find_attribute_value_code("", ""));
+  BOOST_CHECK(!b.find_vendor_attribute_value_name("", 0));
+  BOOST_CHECK(!b.find_vendor_attribute_value_code("", ""));
+
+  BOOST_CHECK(!b.get_attribute_key("Dlink-User-Level", "3GPP"));
+  BOOST_CHECK(!b.get_attribute_key("Unknown", "Dlink"));
+}
+
+BOOST_AUTO_TEST_CASE(TestParse)
+{
+  {
+    std::ofstream stream("dictionary.parse");
+    stream << "# comment\n\n\tATTRIBUTE  Framed-MTU\t12 integer\n" <<
+      "ATTRIBUTE Oid-Attribute 1.2.3\n" <<
+      "VALUE Framed-MTU Default 1500 # trailing comment\n" <<
+      "$INCLUDE dictionary.1\n" <<
+      "VENDOR Dlink 171\n" <<
+      "BEGIN-VENDOR Dlink\n" <<
+      "ATTRIBUTE Dlink-Octets 20 octets[16]\n" <<
+      "END-VENDOR Dlink\n" <<
+      "ATTRIBUTE Last 100 string";
+  }
+
+  radius_lite::Dictionaries a("dictionary.parse");
+  a.resolve();
+
+  BOOST_CHECK_EQUAL(a.attributeCode("Framed-MTU"), 12);
+  BOOST_CHECK_EQUAL(a.attributeTypeName(12), "integer");
+  BOOST_CHECK_THROW(a.attributeCode("Oid-Attribute"), std::out_of_range);
+  BOOST_CHECK_EQUAL(a.attributeValueCode("Framed-MTU", "Default"), 1500);
+  BOOST_CHECK_EQUAL(a.attributeName(1), "User-Name");
+  BOOST_CHECK_EQUAL(a.vendorAttributeCode("Dlink", "Dlink-Octets"), 20);
+  BOOST_CHECK_EQUAL(a.attributeTypeName(20, 171), "octets");
+  BOOST_CHECK_EQUAL(a.attributeName(100), "Last");
+
+  const std::vector<std::string> sources {"dictionary.parse", "dictionary.1"};
+  BOOST_CHECK(a.source_files() == sources);
+}
+
+BOOST_AUTO_TEST_CASE(TestParseInvalid)
+{
+  {
+    std::ofstream stream("dictionary.parse");
+    stream << "VALUE Framed-MTU Default\n";
+  }
+
+  BOOST_CHECK_THROW(radius_lite::Dictionaries("dictionary.parse"), std::runtime_error);
+
+  {
+    std::ofstream stream("dictionary.parse");
+    stream << "$INCLUDE dictionary.missing\n";
+  }
+
+  BOOST_CHECK_THROW(radius_lite::Dictionaries("dictionary.parse"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(frozen_dictionaries_tests)
+
+BOOST_AUTO_TEST_CASE(TestLookups)
+{
+  radius_lite::Dictionaries a("dictionary");
+  a.resolve();
+  const radius_lite::FrozenDictionaries b(a);
+
+  BOOST_CHECK_EQUAL(b.attribute_name(1), "User-Name");
+  BOOST_CHECK_EQUAL(b.attribute_name(6), "Service-Type");
+  BOOST_CHECK(b.attribute_name(5).empty());
+  BOOST_CHECK_EQUAL(*b.attribute_code("User-Password"), 2);
+  BOOST_CHECK(!b.attribute_code("User"));
+
+  BOOST_CHECK_EQUAL(b.vendor_name(171), "Dlink");
+  BOOST_CHECK_EQUAL(*b.vendor_code("Dlink"), 171);
+  BOOST_CHECK(!b.vendor_code(""));
+
+  BOOST_CHECK_EQUAL(b.vendor_attribute_name("Dlink", 10), "Dlink-VLAN-Name");
+  BOOST_CHECK_EQUAL(*b.vendor_attribute_code("Dlink", "Dlink-User-Level"), 1);
+  BOOST_CHECK(b.vendor_attribute_name("Dlin", 10).empty());
+  BOOST_CHECK(!b.vendor_attribute_code("Dlink", "Dlink-User"));
+
+  BOOST_CHECK_EQUAL(b.attribute_value_name("Service-Type", 2), "Framed-User");
+  BOOST_CHECK_EQUAL(*b.attribute_value_code("Service-Type", "Login-User"), 1);
+  BOOST_CHECK(b.attribute_value_name("Service-Type", 3).empty());
+
+  BOOST_CHECK_EQUAL(b.vendor_attribute_value_name("Dlink-User-Level", 3), "User");
+  BOOST_CHECK_EQUAL(*b.vendor_attribute_value_code("Dlink-User-Level", "User-Legacy"), 1);
+  BOOST_CHECK(!b.vendor_attribute_value_code("Dlink-User-Level", "Admin"));
+
+  BOOST_CHECK_EQUAL(b.attribute_type_name(2), "encrypted");
+  BOOST_CHECK_EQUAL(b.attribute_type_name(10, 171), "string");
+  BOOST_CHECK(b.attribute_type_name(5).empty());
+  BOOST_CHECK(b.get_attribute_value_type(6) == radius_lite::AttributeValueType::INTEGER);
+  BOOST_CHECK(b.get_attribute_value_type(1, 171) == radius_lite::AttributeValueType::INTEGER);
+  BOOST_CHECK(b.get_attribute_value_type(2, 171) == radius_lite::AttributeValueType::NONE);
+
+  const auto key = b.get_attribute_key("Dlink-VLAN-Name", "Dlink");
+  BOOST_REQUIRE(key);
+  BOOST_CHECK(*key == radius_lite::Dictionaries::AttributeKey(10, 171));
+  BOOST_CHECK(!b.get_attribute_key("Dlink-VLAN-Name", "3GPP"));
+}
+
+BOOST_AUTO_TEST_CASE(TestSaveLoad)
+{
+  radius_lite::Dictionaries a("dictionary");
+  a.resolve();
+  radius_lite::FrozenDictionaries(a).save("dictionary.image");
+
+  const auto b = radius_lite::FrozenDictionaries::load("dictionary.image");
+
+  BOOST_CHECK_EQUAL(b.attribute_name(1), "User-Name");
+  BOOST_CHECK_EQUAL(*b.attribute_code("User-Password"), 2);
+  BOOST_CHECK_EQUAL(b.vendor_attribute_name("Dlink", 10), "Dlink-VLAN-Name");
+  BOOST_CHECK_EQUAL(*b.vendor_attribute_value_code("Dlink-User-Level", "User-Legacy"), 1);
+  BOOST_CHECK_EQUAL(b.attribute_type_name(10, 171), "string");
+  BOOST_CHECK(b.get_attribute_value_type(6) == radius_lite::AttributeValueType::INTEGER);
+
+  const auto sources = b.source_files();
+  BOOST_REQUIRE_EQUAL(sources.size(), 3);
+  BOOST_CHECK_EQUAL(sources[0], "dictionary");
+  BOOST_CHECK(b.is_up_to_date());
+}
+
+BOOST_AUTO_TEST_CASE(TestOpen)
+{
+  {
+    std::ofstream stream("dictionary.open");
+    stream << "ATTRIBUTE User-Name 1 string\n";
+  }
+
+  std::remove("dictionary.open.image");
+
+  const auto a = radius_lite::FrozenDictionaries::open("dictionary.open", "dictionary.open.image");
+  BOOST_CHECK_EQUAL(a.attribute_name(1), "User-Name");
+
+  const auto b = radius_lite::FrozenDictionaries::load("dictionary.open.image");
+  BOOST_CHECK(b.is_up_to_date());
+
+  {
+    std::ofstream stream("dictionary.open", std::ios::app);
+    stream << "ATTRIBUTE Service-Type 6 integer\n";
+  }
+
+  BOOST_CHECK(!b.is_up_to_date());
+
+  const auto c = radius_lite::FrozenDictionaries::open("dictionary.open", "dictionary.open.image");
+  BOOST_CHECK_EQUAL(c.attribute_name(6), "Service-Type");
+  BOOST_CHECK(radius_lite::FrozenDictionaries::load("dictionary.open.image").is_up_to_date());
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadInvalid)
+{
+  BOOST_CHECK_THROW(radius_lite::FrozenDictionaries::load("dictionary.missing"), std::runtime_error);
+  BOOST_CHECK_THROW(radius_lite::FrozenDictionaries::load("dictionary"), std::runtime_error);
+
+  radius_lite::Dictionaries a("dictionary");
+  a.resolve();
+  radius_lite::FrozenDictionaries(a).save("dictionary.truncated");
+  std::filesystem::resize_file("dictionary.truncated", std::filesystem::file_size("dictionary.truncated") - 8);
+
+  BOOST_CHECK_THROW(radius_lite::FrozenDictionaries::load("dictionary.truncated"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadCorrupted)
+{
+  radius_lite::Dictionaries a("dictionary");
+  a.resolve();
+  radius_lite::FrozenDictionaries(a).save("dictionary.corrupted");
+  const auto size = std::filesystem::file_size("dictionary.corrupted");
+
+  {
+    // last source entry, its path points outside of the string pool
+    std::fstream stream("dictionary.corrupted", std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(static_cast<std::streamoff>(size - 32));
+    const std::string garbage(32, '\xff');
+    stream.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+  }
+
+  BOOST_CHECK_EQUAL(std::filesystem::file_size("dictionary.corrupted"), size);
+  BOOST_CHECK_THROW(radius_lite::FrozenDictionaries::load("dictionary.corrupted"), std::runtime_error);
+
+  const auto b = radius_lite::FrozenDictionaries::open("dictionary", "dictionary.corrupted");
+  BOOST_CHECK_EQUAL(b.attribute_name(1), "User-Name");
+  BOOST_CHECK(radius_lite::FrozenDictionaries::load("dictionary.corrupted").is_up_to_date());
+}
+
+BOOST_AUTO_TEST_CASE(TestDictionaryLookup)
+{
+  radius_lite::Dictionaries a("dictionary");
+  a.resolve();
+  const radius_lite::FrozenDictionaries b(a);
+
+  for (const radius_lite::DictionaryLookup* lookup : {
+    static_cast<const radius_lite::DictionaryLookup*>(&a),
+    static_cast<const radius_lite::DictionaryLookup*>(&b)})
+  {
+    BOOST_CHECK_EQUAL(*lookup->find_attribute_name(1), "User-Name");
+    BOOST_CHECK(!lookup->find_attribute_name(5));
+    BOOST_CHECK_EQUAL(*lookup->find_attribute_code("User-Password"), 2);
+    BOOST_CHECK(!lookup->find_attribute_code("User"));
+    BOOST_CHECK_EQUAL(*lookup->find_attribute_type(10, 171), "string");
+    BOOST_CHECK(!lookup->find_attribute_type(5));
+    BOOST_CHECK(lookup->get_attribute_value_type(6) == radius_lite::AttributeValueType::INTEGER);
+    BOOST_CHECK(*lookup->get_attribute_key("Dlink-VLAN-Name", "Dlink") == radius_lite::AttributeKey(10, 171));
+    BOOST_CHECK(!lookup->get_attribute_key("Dlink-VLAN-Name", "3GPP"));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
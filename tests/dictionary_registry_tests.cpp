@@ -0,0 +1,145 @@
+#define BOOST_TEST_MODULE radius_lite_dictionary_registry_tests
+
+#include <radius_lite/dictionary_registry.h>
+#include <radius_lite/dictionaries.h>
+#include <radius_lite/error.h>
+#include <radius_lite/frozen_dictionaries.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wparentheses"
+#include <boost/test/unit_test.hpp>
+#pragma GCC diagnostic pop
+
+namespace
+{
+  void write_dictionary(const std::string& path, const std::string& content)
+  {
+    std::ofstream stream(path, std::ios::trunc);
+    stream << content;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(dictionary_registry_tests)
+
+BOOST_AUTO_TEST_CASE(TestSnapshot)
+{
+  radius_lite::DictionaryRegistry registry("dictionary");
+
+  BOOST_CHECK_EQUAL(registry.version(), 0);
+  BOOST_CHECK_EQUAL(*registry.snapshot()->find_attribute_name(1), "User-Name");
+  BOOST_CHECK_EQUAL(*registry.snapshot()->find_attribute_type(10, 171), "string");
+}
+
+BOOST_AUTO_TEST_CASE(TestReload)
+{
+  write_dictionary("dictionary.reload", "ATTRIBUTE User-Name 1 string\n");
+  radius_lite::DictionaryRegistry registry("dictionary.reload");
+  radius_lite::DictionaryRegistry::Reader reader(registry);
+
+  const auto old_snapshot = registry.snapshot();
+  BOOST_CHECK(!reader.update());
+  BOOST_CHECK(!reader.dictionaries().find_attribute_name(6));
+
+  write_dictionary("dictionary.reload", "ATTRIBUTE User-Name 1 string\nATTRIBUTE Service-Type 6 integer\n");
+  registry.reload();
+
+  BOOST_CHECK_EQUAL(registry.version(), 1);
+  BOOST_CHECK(reader.snapshot() == old_snapshot);
+  BOOST_CHECK(reader.update());
+  BOOST_CHECK_EQUAL(*reader.dictionaries().find_attribute_name(6), "Service-Type");
+  BOOST_CHECK(!reader.update());
+
+  // holders of the previous snapshot still see it
+  BOOST_CHECK(!old_snapshot->find_attribute_name(6));
+}
+
+BOOST_AUTO_TEST_CASE(TestImageReload)
+{
+  write_dictionary("dictionary.reload", "ATTRIBUTE User-Name 1 string\n");
+  std::remove("dictionary.reload.image");
+  radius_lite::DictionaryRegistry registry("dictionary.reload", "dictionary.reload.image");
+
+  BOOST_CHECK(dynamic_cast<const radius_lite::FrozenDictionaries*>(registry.snapshot().get()));
+  BOOST_CHECK_EQUAL(*registry.snapshot()->find_attribute_name(1), "User-Name");
+  BOOST_CHECK(!registry.snapshot()->find_attribute_name(6));
+
+  write_dictionary("dictionary.reload", "ATTRIBUTE User-Name 1 string\nATTRIBUTE Service-Type 6 integer\n");
+  registry.reload();
+
+  BOOST_CHECK_EQUAL(*registry.snapshot()->find_attribute_name(6), "Service-Type");
+  BOOST_CHECK(registry.snapshot()->get_attribute_value_type(6) == radius_lite::AttributeValueType::INTEGER);
+}
+
+BOOST_AUTO_TEST_CASE(TestReloadFailure)
+{
+  write_dictionary("dictionary.reload", "ATTRIBUTE User-Name 1 string\n");
+  radius_lite::DictionaryRegistry registry("dictionary.reload");
+  const auto old_snapshot = registry.snapshot();
+
+  write_dictionary("dictionary.reload", "ATTRIBUTE User-Name 1 string\nATTRIBUTE User-Name 2 string\n");
+  BOOST_CHECK_THROW(registry.reload(), radius_lite::Exception);
+
+  BOOST_CHECK_EQUAL(registry.version(), 0);
+  BOOST_CHECK(registry.snapshot() == old_snapshot);
+}
+
+BOOST_AUTO_TEST_CASE(TestConcurrentPublish)
+{
+  auto first = std::make_shared<radius_lite::Dictionaries>("dictionary");
+  first->resolve();
+  auto second = std::make_shared<radius_lite::Dictionaries>("dictionary.1");
+  second->resolve();
+
+  radius_lite::DictionaryRegistry registry(first);
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> errors(0);
+
+  std::vector<std::thread> readers;
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    readers.emplace_back(
+      [&registry, &stop, &errors]()
+      {
+        radius_lite::DictionaryRegistry::Reader reader(registry);
+
+        while (!stop.load())
+        {
+          if (reader.dictionaries().find_attribute_name(1) != std::string_view("User-Name"))
+          {
+            ++errors;
+          }
+        }
+      });
+  }
+
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    registry.publish(i % 2 ? first : second);
+  }
+
+  stop = true;
+
+  for (auto& reader : readers)
+  {
+    reader.join();
+  }
+
+  BOOST_CHECK_EQUAL(errors.load(), 0);
+  BOOST_CHECK_EQUAL(registry.version(), 1000);
+  BOOST_CHECK(registry.snapshot() == first);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
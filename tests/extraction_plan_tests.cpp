@@ -0,0 +1,123 @@
+#define BOOST_TEST_MODULE radius_lite_extraction_plan_tests
+
+#include <radius_lite/extraction_plan.h>
+#include <radius_lite/packet.h>
+#include <radius_lite/dictionaries.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint> //uint8_t, uint32_t
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wparentheses"
+#include <boost/test/unit_test.hpp>
+#pragma GCC diagnostic pop
+
+namespace
+{
+  // built once: SecretContext hashes the secret on construction
+  const radius_lite::SecretContext secret("secret");
+
+  // User-Name "test", User-Password "123456", NAS-IP-Address, NAS-Port, Message-Authenticator,
+  // Framed-Protocol, Dlink-User-Level (171/1) = 3
+  const std::vector<uint8_t> request {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  std::string_view toStringView(const radius_lite::ByteSpan& octets)
+  {
+    return std::string_view(reinterpret_cast<const char*>(octets.data()), octets.size());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(extraction_plan_tests)
+
+BOOST_AUTO_TEST_CASE(Extract)
+{
+  using Type = radius_lite::AttributeValueType;
+
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+
+  const radius_lite::ExtractionPlan plan(dictionaries, {
+    {"User-Name", ""},
+    {"Dlink-User-Level", "Dlink"},
+    {"User-Password", ""},
+    {"Service-Type", ""},
+    {"Unknown-Attribute", ""},
+    {"Dlink-VLAN-Name", "Dlink"},
+    {"User-Name", ""}});
+
+  BOOST_REQUIRE_EQUAL(plan.size(), 7);
+
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  std::vector<radius_lite::ExtractionPlan::Value> values(plan.size());
+  plan.extract(p, values.data());
+
+  BOOST_CHECK(values[0].present);
+  BOOST_CHECK(values[0].type == Type::STRING);
+  BOOST_CHECK_EQUAL(toStringView(values[0].octets), "test");
+
+  BOOST_CHECK(values[1].present);
+  BOOST_CHECK(values[1].type == Type::INTEGER);
+  BOOST_CHECK_EQUAL(values[1].integer, 3);
+
+  // "encrypted" isn't a decoder type, decrypted value is returned as octets
+  BOOST_CHECK(values[2].present);
+  BOOST_CHECK(values[2].type == Type::OCTETS);
+  BOOST_CHECK_EQUAL(toStringView(values[2].octets), "123456");
+
+  BOOST_CHECK(!values[3].present);
+  BOOST_CHECK(!values[4].present);
+  BOOST_CHECK(!values[5].present);
+
+  BOOST_CHECK(values[6].present);
+  BOOST_CHECK_EQUAL(toStringView(values[6].octets), "test");
+
+  // values of the previous packet are reset
+  const std::vector<uint8_t> empty {
+    0x04, 0x01, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00};
+  radius_lite::Packet e(empty.data(), empty.size(), secret);
+  plan.extract(e, values.data());
+
+  for (const auto& value : values)
+  {
+    BOOST_CHECK(!value.present);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ExtractTypeMismatch)
+{
+  using Type = radius_lite::AttributeValueType;
+
+  // Framed-Protocol is a string here, the packet decodes it as an integer
+  radius_lite::Dictionaries dictionaries("dictionary.types");
+  dictionaries.resolve();
+
+  const radius_lite::ExtractionPlan plan(dictionaries, {
+    {"Framed-Protocol", ""},
+    {"NAS-Port", ""}});
+
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  std::vector<radius_lite::ExtractionPlan::Value> values(plan.size());
+  plan.extract(p, values.data());
+
+  BOOST_CHECK(values[0].present);
+  BOOST_CHECK(values[0].type == Type::NONE);
+  BOOST_CHECK_EQUAL(values[0].integer, 1);
+  BOOST_CHECK(values[0].octets.empty());
+
+  BOOST_CHECK(values[1].present);
+  BOOST_CHECK(values[1].type == Type::UINT64);
+  BOOST_CHECK_EQUAL(values[1].integer, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
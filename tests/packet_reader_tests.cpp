@@ -0,0 +1,247 @@
+#define BOOST_TEST_MODULE radius_lite_packet_reader_tests
+
+#include <radius_lite/packet_reader.h>
+#include <radius_lite/packet.h>
+#include <radius_lite/dictionaries.h>
+#include <radius_lite/frozen_dictionaries.h>
+#include "attribute_types.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint> //uint8_t, uint32_t
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wparentheses"
+#include <boost/test/unit_test.hpp>
+#pragma GCC diagnostic pop
+
+namespace
+{
+  // built once: SecretContext hashes the secret on construction
+  const radius_lite::SecretContext secret("secret");
+
+  // User-Name "test", User-Password "123456", NAS-IP-Address, NAS-Port, Message-Authenticator,
+  // Framed-Protocol, Dlink-User-Level (171/1) = 3
+  const std::vector<uint8_t> request {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  // User-Name "a", Service-Type 1, User-Name "b", Dlink-User-Level 1, Dlink-VLAN-Name "v", Dlink-User-Level 3
+  const std::vector<uint8_t> repeated {
+    0x04, 0x01, 0x00, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x61, 0x06, 0x06, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x62,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x01, 0x1a, 0x09, 0x00, 0x00,
+    0x00, 0xab, 0x0a, 0x03, 0x76, 0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00,
+    0x03};
+
+  // Dlink-User-Level with a 2 byte value, Dlink-User-Level 3
+  const std::vector<uint8_t> short_integer {
+    0x04, 0x01, 0x00, 0x2a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0xab, 0x01, 0x04, 0x00, 0x03, 0x1a, 0x0c,
+    0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+}
+
+BOOST_AUTO_TEST_SUITE(packet_reader_tests)
+
+BOOST_AUTO_TEST_CASE(GetAttribute)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+
+  auto userName = reader.get_attribute(radius_lite::Dictionaries::AttributeKey(radius_lite::USER_NAME));
+  BOOST_REQUIRE(userName);
+  BOOST_CHECK_EQUAL(*userName->as_string(), "test");
+
+  auto userLevel = reader.get_attribute(radius_lite::Dictionaries::AttributeKey(1, 171));
+  BOOST_REQUIRE(userLevel);
+  BOOST_CHECK_EQUAL(*userLevel->as_uint(), 3);
+
+  // no type in dictionary
+  BOOST_CHECK(!reader.get_attribute(radius_lite::Dictionaries::AttributeKey(radius_lite::NAS_PORT)));
+  // absent in packet
+  BOOST_CHECK(!reader.get_attribute(radius_lite::Dictionaries::AttributeKey(radius_lite::SERVICE_TYPE)));
+  BOOST_CHECK(!reader.get_attribute(radius_lite::Dictionaries::AttributeKey(10, 171)));
+}
+
+BOOST_AUTO_TEST_CASE(GetAttributeFrozen)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  auto frozen = std::make_shared<radius_lite::FrozenDictionaries>(dictionaries);
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, frozen, secret);
+
+  auto userName = reader.get_attribute_by_name("User-Name");
+  BOOST_REQUIRE(userName);
+  BOOST_CHECK_EQUAL(*userName->as_string(), "test");
+
+  auto userLevel = reader.get_attribute_by_name("Dlink-User-Level", "Dlink");
+  BOOST_REQUIRE(userLevel);
+  BOOST_CHECK_EQUAL(*userLevel->as_uint(), 3);
+
+  BOOST_CHECK(!reader.get_attribute(radius_lite::AttributeKey(radius_lite::NAS_PORT)));
+  BOOST_CHECK(!reader.get_attribute_by_name("Dlink-User-Level", "3GPP"));
+}
+
+BOOST_AUTO_TEST_CASE(GetAttributeSnapshot)
+{
+  auto dictionaries = std::make_shared<radius_lite::Dictionaries>("dictionary");
+  dictionaries->resolve();
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+  dictionaries.reset();
+
+  auto userLevel = reader.get_attribute_by_name("Dlink-User-Level", "Dlink");
+  BOOST_REQUIRE(userLevel);
+  BOOST_CHECK_EQUAL(*userLevel->as_uint(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(GetAttributeByName)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+
+  auto userName = reader.get_attribute_by_name("User-Name");
+  BOOST_REQUIRE(userName);
+  BOOST_CHECK_EQUAL(*userName->as_string(), "test");
+
+  auto userLevel = reader.get_attribute_by_name("Dlink-User-Level", "Dlink");
+  BOOST_REQUIRE(userLevel);
+  BOOST_CHECK_EQUAL(*userLevel->as_uint(), 3);
+
+  BOOST_CHECK(!reader.get_attribute_by_name("Unknown-Attribute"));
+  BOOST_CHECK(!reader.get_attribute_by_name("Unknown-Attribute", "Dlink"));
+  BOOST_CHECK(!reader.get_attribute_by_name("Dlink-User-Level", "Unknown-Vendor"));
+  BOOST_CHECK(!reader.get_attribute_by_name("Service-Type"));
+}
+
+BOOST_AUTO_TEST_CASE(GetRepeatedAttributes)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(repeated.data(), repeated.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+
+  auto userName = reader.get_attribute(radius_lite::Dictionaries::AttributeKey(radius_lite::USER_NAME));
+  BOOST_REQUIRE(userName);
+  BOOST_CHECK_EQUAL(*userName->as_string(), "a");
+
+  auto userNames = reader.get_attributes(radius_lite::Dictionaries::AttributeKey(radius_lite::USER_NAME));
+  BOOST_REQUIRE_EQUAL(userNames.size(), 2);
+  BOOST_CHECK_EQUAL(*userNames[0]->as_string(), "a");
+  BOOST_CHECK_EQUAL(*userNames[1]->as_string(), "b");
+
+  auto userLevels = reader.get_attributes(radius_lite::Dictionaries::AttributeKey(1, 171));
+  BOOST_REQUIRE_EQUAL(userLevels.size(), 2);
+  BOOST_CHECK_EQUAL(*userLevels[0]->as_uint(), 1);
+  BOOST_CHECK_EQUAL(*userLevels[1]->as_uint(), 3);
+
+  auto vlanName = reader.get_attribute_by_name("Dlink-VLAN-Name", "Dlink");
+  BOOST_REQUIRE(vlanName);
+  BOOST_CHECK_EQUAL(*vlanName->as_string(), "v");
+
+  BOOST_CHECK(reader.get_attributes(radius_lite::Dictionaries::AttributeKey(radius_lite::CLASS)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GetAttributeInvalidSize)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(short_integer.data(), short_integer.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+
+  // integer of wrong size is skipped, not thrown
+  BOOST_CHECK(!reader.get_attribute(radius_lite::AttributeKey(1, 171)));
+  BOOST_CHECK(!reader.get_attribute_by_name("Dlink-User-Level", "Dlink"));
+
+  auto userLevels = reader.get_attributes(radius_lite::AttributeKey(1, 171));
+  BOOST_REQUIRE_EQUAL(userLevels.size(), 1);
+  BOOST_CHECK_EQUAL(*userLevels[0]->as_uint(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(CheckPassword)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+
+  BOOST_CHECK(reader.check_password("123456"));
+  BOOST_CHECK(!reader.check_password("12345"));
+  BOOST_CHECK(!reader.check_password("123457"));
+  BOOST_CHECK(!reader.check_password(""));
+
+  radius_lite::Packet r(repeated.data(), repeated.size(), secret);
+  radius_lite::PacketReader noPasswordReader(r, dictionaries, secret);
+
+  BOOST_CHECK(!noPasswordReader.check_password("123456"));
+}
+
+BOOST_AUTO_TEST_CASE(CheckPasswordTemporarySecret)
+{
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, radius_lite::SecretContext("secret"));
+
+  BOOST_CHECK(reader.check_password("123456"));
+}
+
+BOOST_AUTO_TEST_CASE(TypedAccessors)
+{
+  using Key = radius_lite::Dictionaries::AttributeKey;
+
+  radius_lite::Dictionaries dictionaries("dictionary");
+  dictionaries.resolve();
+  radius_lite::Packet p(request.data(), request.size(), secret);
+  radius_lite::PacketReader reader(p, dictionaries, secret);
+
+  BOOST_CHECK_EQUAL(*reader.get_uint(Key(radius_lite::NAS_PORT)), 1);
+  BOOST_CHECK_EQUAL(*reader.get_uint(Key(radius_lite::FRAMED_PROTOCOL)), 1);
+  BOOST_CHECK_EQUAL(*reader.get_uint(Key(1, 171)), 3);
+  BOOST_CHECK_EQUAL(*reader.get_uint(Key(radius_lite::NAS_IP_ADDRESS)), 0x7f000001);
+  BOOST_REQUIRE(p.find_attribute(radius_lite::NAS_IP_ADDRESS));
+  BOOST_CHECK_EQUAL(*p.find_attribute(radius_lite::NAS_IP_ADDRESS)->as_uint(), 0x7f000001);
+  BOOST_CHECK(!reader.get_uint(Key(radius_lite::USER_PASSWORD)));
+  BOOST_CHECK(!reader.get_uint(Key(radius_lite::SERVICE_TYPE)));
+
+  const std::array<uint8_t, 4> address {127, 0, 0, 1};
+  BOOST_TEST(*reader.get_ipv4(Key(radius_lite::NAS_IP_ADDRESS)) == address, boost::test_tools::per_element());
+  // integers have no wire view
+  BOOST_CHECK(!reader.get_ipv4(Key(radius_lite::NAS_PORT)));
+  BOOST_CHECK(!reader.get_ipv4(Key(radius_lite::MESSAGE_AUTHENTICATOR)));
+
+  BOOST_CHECK_EQUAL(*reader.get_string_view(Key(radius_lite::USER_NAME)), "test");
+  BOOST_CHECK_EQUAL(*reader.get_string_view(Key(radius_lite::USER_PASSWORD)), "123456");
+  BOOST_CHECK(!reader.get_string_view(Key(radius_lite::CLASS)));
+
+  const auto authenticator = reader.get_octets_view(Key(radius_lite::MESSAGE_AUTHENTICATOR));
+  BOOST_REQUIRE(authenticator);
+  BOOST_CHECK_EQUAL(authenticator->size(), 16);
+  BOOST_CHECK_EQUAL((*authenticator)[0], 0xf3);
+
+  const auto userLevel = reader.get_octets_view(Key(1, 171));
+  BOOST_REQUIRE(userLevel);
+  BOOST_CHECK_EQUAL(userLevel->size(), 4);
+  BOOST_CHECK(!reader.get_octets_view(Key(10, 171)));
+
+  radius_lite::Packet r(repeated.data(), repeated.size(), secret);
+  radius_lite::PacketReader repeatedReader(r, dictionaries, secret);
+
+  BOOST_CHECK_EQUAL(*repeatedReader.get_string_view(Key(radius_lite::USER_NAME)), "a");
+  BOOST_CHECK_EQUAL(*repeatedReader.get_string_view(Key(10, 171)), "v");
+  BOOST_CHECK_EQUAL(*repeatedReader.get_uint(Key(1, 171)), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,12 +5,20 @@
 #include <radius_lite/vendor_attribute.h>
 #include "attribute_types.h"
 #include <radius_lite/error.h>
+#include <radius_lite/packet_arena.h>
+#include <radius_lite/packet_buffer.h>
+#include <radius_lite/packet_codes.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
 #include "utils.h"
 #include <memory>
+#include <optional>
 #include <array>
 #include <vector>
 #include <set>
 #include <string>
+#include <future>
+#include <thread>
 #include <cstdint> //uint8_t, uint32_t
 
 #pragma GCC diagnostic push
@@ -21,6 +29,12 @@
 #include <boost/test/unit_test.hpp>
 #pragma GCC diagnostic pop
 
+namespace
+{
+  // built once: SecretContext hashes the secret on construction
+  const radius_lite::SecretContext secret("secret");
+}
+
 BOOST_AUTO_TEST_SUITE(packet_tests)
 
 BOOST_AUTO_TEST_CASE(PacketBufferConstructorRequest)
@@ -33,7 +47,7 @@ BOOST_AUTO_TEST_CASE(PacketBufferConstructorRequest)
     0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
     0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
 
-  radius_lite::Packet p(d.data(), d.size(), "secret");
+  radius_lite::Packet p(d.data(), d.size(), secret);
 
   BOOST_CHECK_EQUAL(p.type(), 1);
 
@@ -104,7 +118,7 @@ BOOST_AUTO_TEST_CASE(PacketBufferConstructorRequest)
   BOOST_CHECK(types.count(attrs[4]->type()) == 1);
   BOOST_CHECK(types.count(attrs[5]->type()) == 1);
 
-  std::vector<uint8_t> values = p.makeSendBuffer("secret");
+  std::vector<uint8_t> values = p.makeSendBuffer(secret);
 
   BOOST_REQUIRE_EQUAL(values.size(), 92);
 
@@ -122,7 +136,7 @@ BOOST_AUTO_TEST_CASE(PacketBufferConstructorResponse)
     0x01, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
     0x67, 0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
 
-  radius_lite::Packet p(d.data(), d.size(), "secret");
+  radius_lite::Packet p(d.data(), d.size(), secret);
 
   BOOST_CHECK_EQUAL(p.type(), 2);
 
@@ -186,7 +200,7 @@ BOOST_AUTO_TEST_CASE(PacketBufferConstructorResponse)
   BOOST_CHECK(types.count(attrs[3]->type()) == 1);
   BOOST_CHECK(types.count(attrs[4]->type()) == 1);
 
-  std::vector<uint8_t> values = p.makeSendBuffer("secret");
+  std::vector<uint8_t> values = p.makeSendBuffer(secret);
 
   BOOST_REQUIRE_EQUAL(values.size(), 77);
 
@@ -201,7 +215,7 @@ BOOST_AUTO_TEST_CASE(PacketDataConstructorThrowSizeLess20)
     0x02, 0xd0, 0x00, 0x4d, 0x93, 0xa9, 0x61, 0x8b, 0x2f, 0x4c, 0x5a, 0x51, 0x65, 0x67, 0x3d, 0xb4,
     0x07, 0x30, 0xa2};
 
-  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), "secret"), radius_lite::Exception);
+  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), secret), radius_lite::Exception);
 }
 
 BOOST_AUTO_TEST_CASE(PacketDataConstructorThrowSizeLessLength)
@@ -213,7 +227,7 @@ BOOST_AUTO_TEST_CASE(PacketDataConstructorThrowSizeLessLength)
     0x01, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
     0x67, 0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00};
 
-  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), "secret"), radius_lite::Exception);
+  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), secret), radius_lite::Exception);
 }
 
 BOOST_AUTO_TEST_CASE(PacketDataConstructorThrowMakeAttributeInvalidType)
@@ -225,7 +239,7 @@ BOOST_AUTO_TEST_CASE(PacketDataConstructorThrowMakeAttributeInvalidType)
     0x01, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
     0x67, 0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
 
-  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), "secret"), radius_lite::Exception);
+  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), secret), radius_lite::Exception);
 }
 
 BOOST_AUTO_TEST_CASE(PacketValueConstructorResponse)
@@ -310,7 +324,7 @@ BOOST_AUTO_TEST_CASE(PacketValueConstructorResponse)
   BOOST_CHECK(types.count(attrs[3]->type()) == 1);
   BOOST_CHECK(types.count(attrs[4]->type()) == 1);
 
-  std::vector<uint8_t> values = p.makeSendBuffer("secret");
+  std::vector<uint8_t> values = p.makeSendBuffer(secret);
 
   BOOST_REQUIRE_EQUAL(values.size(), d.size());
 
@@ -409,7 +423,7 @@ BOOST_AUTO_TEST_CASE(PacketValueConstructorRequest)
   BOOST_CHECK(types.count(attrs[4]->type()) == 1);
   BOOST_CHECK(types.count(attrs[5]->type()) == 1);
 
-  std::vector<uint8_t> values = p.makeSendBuffer("secret");
+  std::vector<uint8_t> values = p.makeSendBuffer(secret);
 
   BOOST_REQUIRE_EQUAL(values.size(), d.size());
 
@@ -426,7 +440,7 @@ BOOST_AUTO_TEST_CASE(PacketCopyConstructorRequest)
     0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
     0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
 
-  radius_lite::Packet other(d.data(), d.size(), "secret");
+  radius_lite::Packet other(d.data(), d.size(), secret);
   radius_lite::Packet p(other);
 
   BOOST_CHECK_EQUAL(p.type(), other.type());
@@ -495,7 +509,7 @@ BOOST_AUTO_TEST_CASE(PacketCopyConstructorRequest)
   BOOST_CHECK(types.count(attrs[4]->type()) == 1);
   BOOST_CHECK(types.count(attrs[5]->type()) == 1);
 
-  std::vector<uint8_t> values = p.makeSendBuffer("secret");
+  std::vector<uint8_t> values = p.makeSendBuffer(secret);
 
   BOOST_REQUIRE_EQUAL(values.size(), 92);
 
@@ -513,7 +527,7 @@ BOOST_AUTO_TEST_CASE(PacketCopyConstructorResponse)
     0x01, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
     0x67, 0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
 
-  radius_lite::Packet other(d.data(), d.size(), "secret");
+  radius_lite::Packet other(d.data(), d.size(), secret);
   radius_lite::Packet p(other);
 
   BOOST_CHECK_EQUAL(p.type(), other.type());
@@ -575,7 +589,7 @@ BOOST_AUTO_TEST_CASE(PacketCopyConstructorResponse)
   BOOST_CHECK(types.count(attrs[3]->type()) == 1);
   BOOST_CHECK(types.count(attrs[4]->type()) == 1);
 
-  std::vector<uint8_t> values = p.makeSendBuffer("secret");
+  std::vector<uint8_t> values = p.makeSendBuffer(secret);
 
   BOOST_REQUIRE_EQUAL(values.size(), 77);
 
@@ -584,4 +598,306 @@ BOOST_AUTO_TEST_CASE(PacketCopyConstructorResponse)
   BOOST_TEST(values == d, boost::test_tools::per_element());
 }
 
+BOOST_AUTO_TEST_CASE(PacketArenaConstructor)
+{
+  std::vector<uint8_t> d {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  std::unique_ptr<radius_lite::Packet> copy;
+
+  {
+    radius_lite::Packet p(d.data(), d.size(), secret, radius_lite::PacketArena::acquire());
+
+    BOOST_REQUIRE_EQUAL(p.attributes().size(), 6);
+
+    auto* attr0 = findAttribute(p.attributes(), radius_lite::USER_NAME);
+    BOOST_REQUIRE(attr0 != nullptr);
+    BOOST_CHECK_EQUAL(attr0->toString(), "test");
+
+    auto* attr1 = findAttribute(p.attributes(), radius_lite::USER_PASSWORD);
+    BOOST_REQUIRE(attr1 != nullptr);
+    BOOST_CHECK_EQUAL(attr1->toString(), "123456");
+
+    BOOST_REQUIRE_EQUAL(p.vendorSpecific().size(), 1);
+    BOOST_CHECK_EQUAL(p.vendorSpecific()[0].toString(), "00000003");
+
+    // copy doesn't reference the arena of the source packet
+    copy = std::make_unique<radius_lite::Packet>(p);
+  }
+
+  auto* attr0 = findAttribute(copy->attributes(), radius_lite::USER_NAME);
+  BOOST_REQUIRE(attr0 != nullptr);
+  BOOST_CHECK_EQUAL(attr0->toString(), "test");
+  BOOST_CHECK_EQUAL(copy->vendorSpecific()[0].toString(), "00000003");
+}
+
+BOOST_AUTO_TEST_CASE(PacketDecodeTable)
+{
+  using Kind = radius_lite::AttributeDecodeTable::Kind;
+
+  const auto& standard = radius_lite::AttributeDecodeTable::standard();
+  BOOST_CHECK(standard.kind(radius_lite::USER_NAME) == Kind::STRING);
+  BOOST_CHECK(standard.kind(radius_lite::USER_PASSWORD) == Kind::ENCRYPTED);
+  BOOST_CHECK(standard.kind(radius_lite::CHAP_PASSWORD) == Kind::CHAP_PASSWORD);
+  BOOST_CHECK(standard.kind(radius_lite::NAS_IP_ADDRESS) == Kind::IP_ADDRESS);
+  BOOST_CHECK(standard.kind(radius_lite::NAS_PORT) == Kind::INTEGER32);
+  BOOST_CHECK(standard.kind(200) == Kind::BYTES);
+
+  radius_lite::Dictionaries dictionaries("dictionary.types");
+  dictionaries.resolve();
+  const radius_lite::AttributeDecodeTable table(dictionaries);
+
+  BOOST_CHECK(table.kind(radius_lite::USER_NAME) == Kind::BYTES);
+  // password encoding isn't a dictionary type
+  BOOST_CHECK(table.kind(radius_lite::USER_PASSWORD) == Kind::ENCRYPTED);
+  BOOST_CHECK(table.kind(radius_lite::NAS_PORT) == Kind::INTEGER64);
+  // type unknown to Packet
+  BOOST_CHECK(table.kind(radius_lite::LOGIN_IP_HOST) == Kind::IP_ADDRESS);
+  BOOST_CHECK(table.kind(200) == Kind::IP_ADDRESS);
+  BOOST_CHECK(table.kind(radius_lite::SERVICE_TYPE) == Kind::INTEGER32);
+
+  std::vector<uint8_t> d {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  radius_lite::Packet p(d.data(), d.size(), secret, radius_lite::PacketArenaPtr(), table);
+
+  auto* userName = p.find_attribute(radius_lite::USER_NAME);
+  BOOST_REQUIRE(dynamic_cast<const radius_lite::Bytes*>(userName) != nullptr);
+  BOOST_CHECK_EQUAL(userName->toString(), "74657374");
+
+  auto* userPassword = p.find_attribute(radius_lite::USER_PASSWORD);
+  BOOST_REQUIRE(dynamic_cast<const radius_lite::Encrypted*>(userPassword) != nullptr);
+  BOOST_CHECK_EQUAL(userPassword->toString(), "123456");
+
+  auto* nasPort = p.find_attribute(radius_lite::NAS_PORT);
+  BOOST_REQUIRE(dynamic_cast<const radius_lite::Integer<uint64_t>*>(nasPort) != nullptr);
+  BOOST_CHECK_EQUAL(nasPort->toString(), "1");
+}
+
+BOOST_AUTO_TEST_CASE(PacketMoveConstructor)
+{
+  std::vector<uint8_t> d {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  std::optional<radius_lite::Packet> source;
+  source.emplace(d.data(), d.size(), secret, radius_lite::PacketArena::acquire());
+
+  const radius_lite::Attribute* userName = source->find_attribute(radius_lite::USER_NAME);
+
+  radius_lite::Packet p(std::move(*source));
+  source.reset();
+
+  // attributes are taken over, not cloned
+  BOOST_REQUIRE_EQUAL(p.attributes().size(), 6);
+  BOOST_CHECK(p.find_attribute(radius_lite::USER_NAME) == userName);
+  BOOST_CHECK_EQUAL(userName->toString(), "test");
+  BOOST_CHECK_EQUAL(p.type(), 1);
+  BOOST_CHECK_EQUAL(p.id(), 208);
+
+  const radius_lite::VendorSpecific* userLevel = p.find_vendor_attribute(171, 1);
+  BOOST_REQUIRE(userLevel != nullptr);
+  BOOST_CHECK_EQUAL(userLevel->toString(), "00000003");
+}
+
+BOOST_AUTO_TEST_CASE(PacketEncodeIntoBuffer)
+{
+  std::vector<uint8_t> d {
+    0x02, 0xd0, 0x00, 0x4d, 0x93, 0xa9, 0x61, 0x8b, 0x2f, 0x4c, 0x5a, 0x51, 0x65, 0x67, 0x3d, 0xb4,
+    0x07, 0x30, 0xa2, 0x39, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x05, 0x06, 0x00, 0x00, 0x00, 0x14,
+    0x04, 0x06, 0x7f, 0x68, 0x16, 0x11, 0x13, 0x08, 0x31, 0x32, 0x33, 0x61, 0x62, 0x63, 0x03, 0x13,
+    0x01, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66,
+    0x67, 0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  radius_lite::Packet p(d.data(), d.size(), secret);
+
+  BOOST_CHECK_EQUAL(p.encoded_size(), d.size());
+
+  std::array<uint8_t, 4096> buffer;
+  const size_t length = p.encode(buffer.data(), buffer.size(), secret);
+
+  BOOST_REQUIRE_EQUAL(length, d.size());
+  BOOST_TEST(std::vector<uint8_t>(buffer.begin(), buffer.begin() + length) == d, boost::test_tools::per_element());
+
+  BOOST_CHECK_THROW(p.encode(buffer.data(), d.size() - 1, secret), radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketMessageAuthenticatorRequest)
+{
+  std::vector<uint8_t> d {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  const radius_lite::SecretContext other("other");
+
+  radius_lite::PacketView view(d.data(), d.size());
+  BOOST_CHECK(view.has_message_authenticator());
+  BOOST_CHECK(view.check_message_authenticator(secret, view.auth()));
+  BOOST_CHECK(!view.check_message_authenticator(other, view.auth()));
+  BOOST_CHECK_NO_THROW(radius_lite::Packet p(d.data(), d.size(), secret));
+  BOOST_CHECK_THROW(radius_lite::Packet p(d.data(), d.size(), other), radius_lite::Exception);
+
+  // NAS-Port changed
+  std::vector<uint8_t> changed(d);
+  changed[55] = 0x02;
+  BOOST_CHECK_THROW(radius_lite::Packet p(changed.data(), changed.size(), secret), radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketParse)
+{
+  std::vector<uint8_t> d {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+
+  boost::system::error_code ec;
+
+  const auto packet = radius_lite::Packet::parse(d.data(), d.size(), secret, ec);
+  BOOST_REQUIRE(packet);
+  BOOST_CHECK(!ec);
+  BOOST_CHECK(packet->find_attribute(radius_lite::NAS_PORT) != nullptr);
+
+  BOOST_CHECK(!radius_lite::Packet::parse(d.data(), d.size(), radius_lite::SecretContext("other"), ec));
+  BOOST_CHECK(ec == radius_lite::Error::invalidMessageAuthenticator);
+
+  BOOST_CHECK(!radius_lite::Packet::parse(d.data(), 19, secret, ec));
+  BOOST_CHECK(ec == radius_lite::Error::numberOfBytesIsLessThan20);
+
+  // NAS-Port of 3 bytes
+  const std::vector<uint8_t> shortInteger {
+    0x04, 0x01, 0x00, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x05, 0x05, 0x00, 0x00, 0x01};
+
+  BOOST_CHECK(!radius_lite::Packet::parse(shortInteger.data(), shortInteger.size(), secret, ec));
+  BOOST_CHECK(ec == radius_lite::Error::invalidAttributeSize);
+  BOOST_CHECK_THROW(
+    radius_lite::Packet p(shortInteger.data(), shortInteger.size(), secret),
+    radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketMessageAuthenticatorResponse)
+{
+  std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  const std::vector<radius_lite::Attribute*> attributes {
+    new radius_lite::String(radius_lite::USER_NAME, "test"),
+    new radius_lite::Integer<uint32_t>(radius_lite::SESSION_TIMEOUT, 3600)};
+
+  radius_lite::Packet p(radius_lite::ACCESS_ACCEPT, 208, auth, attributes, {});
+  p.addMessageAuthenticator();
+  p.addMessageAuthenticator();
+
+  BOOST_REQUIRE_EQUAL(p.attributes().size(), 3);
+
+  const std::vector<uint8_t> values = p.makeSendBuffer(secret);
+  BOOST_REQUIRE_EQUAL(values.size(), 20 + 6 + 6 + 18);
+
+  // HMAC-MD5 over the packet with request authenticator and zero Message-Authenticator
+  std::vector<uint8_t> signed_data(values);
+  std::copy(auth.begin(), auth.end(), signed_data.begin() + 4);
+  std::fill(signed_data.begin() + 34, signed_data.end(), 0);
+  std::array<uint8_t, 16> expected;
+  unsigned int expected_size = 0;
+  HMAC(EVP_md5(), "secret", 6, signed_data.data(), signed_data.size(), expected.data(), &expected_size);
+
+  BOOST_CHECK_EQUAL(values[32], radius_lite::MESSAGE_AUTHENTICATOR);
+  BOOST_TEST(std::vector<uint8_t>(values.begin() + 34, values.end()) ==
+    std::vector<uint8_t>(expected.begin(), expected.end()), boost::test_tools::per_element());
+
+  radius_lite::PacketView view(values.data(), values.size());
+  BOOST_CHECK(view.check_message_authenticator(secret, auth));
+  BOOST_CHECK(!view.check_message_authenticator(secret, view.auth()));
+}
+
+BOOST_AUTO_TEST_CASE(PacketArenaReuse)
+{
+  radius_lite::PacketArena arena(64);
+
+  void* first = arena.allocate(48, 8);
+  void* second = arena.allocate(48, 8);
+
+  BOOST_CHECK(first != second);
+  BOOST_CHECK_EQUAL(arena.chunks_count(), 2);
+
+  arena.reset();
+
+  BOOST_CHECK(arena.allocate(48, 8) == first);
+  BOOST_CHECK(arena.allocate(48, 8) == second);
+  BOOST_CHECK_EQUAL(arena.chunks_count(), 2);
+
+  // pooled arena is handed out again after release
+  radius_lite::PacketArena* pooled = nullptr;
+
+  {
+    auto ptr = radius_lite::PacketArena::acquire();
+    pooled = ptr.get();
+  }
+
+  auto ptr = radius_lite::PacketArena::acquire();
+  BOOST_CHECK(ptr.get() == pooled);
+}
+
+BOOST_AUTO_TEST_CASE(PoolReleaseOnAnotherThread)
+{
+  radius_lite::PacketBufferPtr buffer;
+  radius_lite::PacketArenaPtr arena;
+  std::promise<void> acquired;
+  std::promise<void> released;
+  auto acquired_future = acquired.get_future();
+  auto released_future = released.get_future();
+  bool buffer_returned = false;
+  bool arena_returned = false;
+
+  // acquired by the worker and released here, the worker gets them back from its pool
+  std::thread worker(
+    [&]()
+    {
+      buffer = radius_lite::PacketBuffer::acquire();
+      arena = radius_lite::PacketArena::acquire();
+      const radius_lite::PacketBuffer* const pooled_buffer = buffer.get();
+      const radius_lite::PacketArena* const pooled_arena = arena.get();
+      acquired.set_value();
+
+      released_future.wait();
+      buffer_returned = radius_lite::PacketBuffer::acquire().get() == pooled_buffer;
+      arena_returned = radius_lite::PacketArena::acquire().get() == pooled_arena;
+    });
+
+  acquired_future.wait();
+  buffer.reset();
+  arena.reset();
+  released.set_value();
+  worker.join();
+
+  BOOST_CHECK(buffer_returned);
+  BOOST_CHECK(arena_returned);
+
+  // pool of an exited thread is freed with the last buffer it handed out
+  radius_lite::PacketBufferPtr orphan;
+  std::thread([&orphan]() { orphan = radius_lite::PacketBuffer::acquire(); }).join();
+  orphan.reset();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
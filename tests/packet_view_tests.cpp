@@ -0,0 +1,191 @@
+#define BOOST_TEST_MODULE radius_lite_packet_view_tests
+
+#include <radius_lite/packet_view.h>
+#include <radius_lite/packet.h>
+#include <radius_lite/error.h>
+#include "attribute_types.h"
+#include "utils.h"
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint> //uint8_t, uint32_t
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wparentheses"
+#include <boost/test/unit_test.hpp>
+#pragma GCC diagnostic pop
+
+namespace
+{
+  // built once: SecretContext hashes the secret on construction
+  const radius_lite::SecretContext secret("secret");
+
+  const std::vector<uint8_t> request {
+    0x01, 0xd0, 0x00, 0x5c, 0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c,
+    0x3e, 0x83, 0x12, 0x45, 0x01, 0x06, 0x74, 0x65, 0x73, 0x74, 0x02, 0x12, 0x8c, 0x06, 0xc8, 0x23,
+    0x55, 0xba, 0x0d, 0xd6, 0x15, 0x1c, 0xbf, 0x9d, 0xd8, 0x1a, 0x4d, 0x87, 0x04, 0x06, 0x7f, 0x00,
+    0x00, 0x01, 0x05, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x12, 0xf3, 0xe0, 0x00, 0xe7, 0x7d, 0xeb,
+    0x51, 0xeb, 0x81, 0x5d, 0x52, 0x37, 0x3d, 0x06, 0xb7, 0x1b, 0x07, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x1a, 0x0c, 0x00, 0x00, 0x00, 0xab, 0x01, 0x06, 0x00, 0x00, 0x00, 0x03};
+}
+
+BOOST_AUTO_TEST_SUITE(packet_view_tests)
+
+BOOST_AUTO_TEST_CASE(PacketViewHeader)
+{
+  radius_lite::PacketView v(request.data(), request.size());
+
+  BOOST_CHECK_EQUAL(v.type(), 1);
+  BOOST_CHECK_EQUAL(v.id(), 0xd0);
+  BOOST_CHECK_EQUAL(v.length(), 92);
+  BOOST_CHECK(v.data() == request.data());
+
+  std::array<uint8_t, 16> authExpected {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  BOOST_TEST(v.auth() == authExpected, boost::test_tools::per_element());
+
+  BOOST_CHECK_EQUAL(v.attributes_count(), 6);
+  BOOST_CHECK_EQUAL(v.vendor_attributes_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewAttributes)
+{
+  radius_lite::PacketView v(request.data(), request.size());
+
+  std::vector<uint8_t> types;
+  for (const auto& attribute : v)
+  {
+    types.push_back(attribute.type);
+    // values point into the source buffer
+    BOOST_CHECK(attribute.value.data() > request.data());
+    BOOST_CHECK(attribute.value.end() <= request.data() + request.size());
+  }
+
+  std::vector<uint8_t> typesExpected {1, 2, 4, 5, 80, 7, 26};
+  BOOST_TEST(types == typesExpected, boost::test_tools::per_element());
+
+  auto userName = v.find_attribute(radius_lite::USER_NAME);
+  BOOST_REQUIRE(userName.has_value());
+  BOOST_CHECK_EQUAL(std::string(userName->begin(), userName->end()), "test");
+
+  auto nasPort = v.find_attribute(radius_lite::NAS_PORT);
+  BOOST_REQUIRE(nasPort.has_value());
+  std::vector<uint8_t> nasPortExpected {0, 0, 0, 1};
+  BOOST_TEST(std::vector<uint8_t>(nasPort->begin(), nasPort->end()) == nasPortExpected, boost::test_tools::per_element());
+
+  BOOST_CHECK(!v.find_attribute(radius_lite::CALLING_STATION_ID).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewVendorAttributes)
+{
+  radius_lite::PacketView v(request.data(), request.size());
+
+  auto vendorValue = v.find_vendor_attribute(171, 1);
+  BOOST_REQUIRE(vendorValue.has_value());
+  std::vector<uint8_t> vendorValueExpected {0, 0, 0, 3};
+  BOOST_TEST(
+    std::vector<uint8_t>(vendorValue->begin(), vendorValue->end()) == vendorValueExpected,
+    boost::test_tools::per_element());
+
+  BOOST_CHECK(!v.find_vendor_attribute(171, 2).has_value());
+  BOOST_CHECK(!v.find_vendor_attribute(172, 1).has_value());
+
+  for (const auto& attribute : v)
+  {
+    if (attribute.type == radius_lite::VENDOR_SPECIFIC)
+    {
+      const auto vendorAttribute = radius_lite::PacketView::vendor_attribute(attribute);
+      BOOST_CHECK_EQUAL(vendorAttribute.vendor_id, 171);
+      BOOST_CHECK_EQUAL(vendorAttribute.vendor_type, 1);
+      BOOST_CHECK_EQUAL(vendorAttribute.value.size(), 4);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewToPacket)
+{
+  radius_lite::PacketView v(request.data(), request.size());
+  radius_lite::Packet p(v, secret);
+
+  BOOST_CHECK_EQUAL(p.type(), 1);
+  BOOST_CHECK_EQUAL(p.id(), 0xd0);
+  BOOST_TEST(p.auth() == v.auth(), boost::test_tools::per_element());
+  BOOST_CHECK_EQUAL(p.attributes().size(), 6);
+  BOOST_CHECK_EQUAL(p.vendorSpecific().size(), 1);
+
+  auto* password = findAttribute(p.attributes(), radius_lite::USER_PASSWORD);
+  BOOST_REQUIRE(password != nullptr);
+  BOOST_CHECK_EQUAL(password->toString(), "123456");
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewThrowSizeLess20)
+{
+  std::vector<uint8_t> d(request.begin(), request.begin() + 19);
+
+  BOOST_CHECK_THROW(radius_lite::PacketView(d.data(), d.size()), radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewThrowSizeLessLength)
+{
+  std::vector<uint8_t> d(request.begin(), request.end() - 1);
+
+  BOOST_CHECK_THROW(radius_lite::PacketView(d.data(), d.size()), radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewThrowAttributeLength)
+{
+  std::vector<uint8_t> zeroLength(request);
+  zeroLength[21] = 0;
+
+  BOOST_CHECK_THROW(radius_lite::PacketView(zeroLength.data(), zeroLength.size()), radius_lite::Exception);
+
+  std::vector<uint8_t> overrun(request);
+  overrun[request.size() - 11] = 0x0d;
+
+  BOOST_CHECK_THROW(radius_lite::PacketView(overrun.data(), overrun.size()), radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewThrowVendorSpecific)
+{
+  std::vector<uint8_t> vendorId(request);
+  vendorId[request.size() - 10] = 1;
+
+  BOOST_CHECK_THROW(radius_lite::PacketView(vendorId.data(), vendorId.size()), radius_lite::Exception);
+
+  std::vector<uint8_t> vendorLength(request);
+  vendorLength[request.size() - 5] = 0x07;
+
+  BOOST_CHECK_THROW(radius_lite::PacketView(vendorLength.data(), vendorLength.size()), radius_lite::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PacketViewParse)
+{
+  boost::system::error_code ec;
+
+  const auto view = radius_lite::PacketView::parse(request.data(), request.size(), ec);
+  BOOST_REQUIRE(view);
+  BOOST_CHECK(!ec);
+  BOOST_CHECK_EQUAL(view->length(), request.size());
+
+  BOOST_CHECK(!radius_lite::PacketView::parse(request.data(), 19, ec));
+  BOOST_CHECK(ec == radius_lite::Error::numberOfBytesIsLessThan20);
+
+  BOOST_CHECK(!radius_lite::PacketView::parse(request.data(), request.size() - 1, ec));
+  BOOST_CHECK(ec == radius_lite::Error::requestLengthIsShort);
+
+  std::vector<uint8_t> zeroLength(request);
+  zeroLength[21] = 0;
+  BOOST_CHECK(!radius_lite::PacketView::parse(zeroLength.data(), zeroLength.size(), ec));
+  BOOST_CHECK(ec == radius_lite::Error::invalidAttributeSize);
+
+  std::vector<uint8_t> vendorId(request);
+  vendorId[request.size() - 10] = 1;
+  BOOST_CHECK(!radius_lite::PacketView::parse(vendorId.data(), vendorId.size(), ec));
+  BOOST_CHECK(ec == radius_lite::Error::invalidVendorSpecificAttributeId);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,75 @@
+#define BOOST_TEST_MODULE radius_lite_secret_context_tests
+
+#include <radius_lite/secret_context.h>
+#include <radius_lite/attribute.h>
+#include <openssl/md5.h>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint> //uint8_t, uint32_t
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wparentheses"
+#include <boost/test/unit_test.hpp>
+#pragma GCC diagnostic pop
+
+BOOST_AUTO_TEST_SUITE(secret_context_tests)
+
+BOOST_AUTO_TEST_CASE(PrecomputedState)
+{
+  const std::string secret = "a-rather-long-shared-secret-of-a-nas";
+  const std::array<uint8_t, 16> auth {
+    0x92, 0xfa, 0xa1, 0xed, 0x98, 0x9b, 0xb4, 0x79, 0xfe, 0x20, 0xe2, 0xf4, 0x7f, 0x4a, 0x5a, 0x70};
+
+  radius_lite::SecretContext context(secret);
+
+  BOOST_CHECK_EQUAL(context.secret(), secret);
+
+  // state continued with auth gives MD5(secret + auth), the state itself isn't changed
+  for (size_t i = 0; i < 2; ++i)
+  {
+    MD5_CTX state = context.md5();
+    MD5_Update(&state, auth.data(), auth.size());
+    std::array<uint8_t, 16> md;
+    MD5_Final(md.data(), &state);
+
+    std::vector<uint8_t> data(secret.begin(), secret.end());
+    data.insert(data.end(), auth.begin(), auth.end());
+    std::array<uint8_t, 16> expected;
+    MD5(data.data(), data.size(), expected.data());
+
+    BOOST_TEST(md == expected, boost::test_tools::per_element());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Comparison)
+{
+  BOOST_CHECK(radius_lite::SecretContext("secret") == radius_lite::SecretContext(std::string("secret")));
+  BOOST_CHECK(radius_lite::SecretContext("secret") != radius_lite::SecretContext("other"));
+  BOOST_CHECK(radius_lite::SecretContext() == radius_lite::SecretContext(""));
+}
+
+BOOST_AUTO_TEST_CASE(EncryptedWithOtherSecret)
+{
+  std::array<uint8_t, 16> auth {
+    0x92, 0xfa, 0xa1, 0xed, 0x98, 0x9b, 0xb4, 0x79, 0xfe, 0x20, 0xe2, 0xf4, 0x7f, 0x4a, 0x5a, 0x70};
+  std::vector<uint8_t> d {
+    0x25, 0x38, 0x58, 0x18, 0xae, 0x97, 0xeb, 0xeb, 0xbd, 0x46, 0xfd, 0xb9, 0xd1, 0x17, 0x84, 0xeb};
+  const radius_lite::SecretContext secret("secret");
+  const radius_lite::SecretContext other("other");
+
+  radius_lite::Encrypted s(2, d.data(), d.size(), secret, auth);
+
+  // re-encrypted with other secret, decrypted back with it
+  const std::vector<uint8_t> values = s.data(other, auth);
+  BOOST_CHECK(values != d);
+
+  radius_lite::Encrypted o(2, values.data(), values.size(), other, auth);
+  BOOST_CHECK_EQUAL(o.toString(), "123456");
+  BOOST_TEST(o.data(secret, auth) == d, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,12 +6,17 @@
 #include <string>
 #include <cstdint> //uint8_t, uint32_t
 #include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <boost/asio.hpp>
 
 #include "attribute_types.h"
 #include "utils.h"
 #include <radius_lite/socket.h>
+#include <radius_lite/socket_group.h>
 #include <radius_lite/error.h>
+#include <radius_lite/packet_codes.h>
 #include <radius_lite/attribute.h>
 #include <radius_lite/vendor_attribute.h>
 
@@ -27,6 +32,9 @@ using boost::system::error_code;
 
 namespace
 {
+  // built once: SecretContext hashes the secret on construction
+  const radius_lite::SecretContext secret("secret");
+
   bool callbackReceiveCalled = false;
   bool callbackSendCalled = false;
 
@@ -122,11 +130,48 @@ BOOST_AUTO_TEST_CASE(TestConstructor)
   boost::asio::io_service io_service;
   BOOST_CHECK_NO_THROW(radius_lite::Socket s(
     io_service,
-    "secret",
+    secret,
     3000,
     [this](const auto&, const auto&, const boost::asio::ip::udp::endpoint&){}));
 }
 
+BOOST_AUTO_TEST_CASE(TestViewConstructor)
+{
+  boost::asio::io_service io_service;
+  BOOST_CHECK_NO_THROW(radius_lite::Socket s(
+    io_service,
+    secret,
+    3001,
+    [](const error_code&, const std::optional<radius_lite::PacketView>&, const boost::asio::ip::udp::endpoint&){}));
+}
+
+BOOST_AUTO_TEST_CASE(TestViewConstructorReusePort)
+{
+  boost::asio::io_service io_service;
+  const auto callback =
+    [](const error_code&, const std::optional<radius_lite::PacketView>&, const boost::asio::ip::udp::endpoint&){};
+
+  // both sockets bind the same port, io_uring falls back to asio on old kernels
+  radius_lite::Socket first(io_service, secret, 3010, callback, true);
+  BOOST_CHECK_NO_THROW(radius_lite::Socket second(
+    io_service,
+    secret,
+    3010,
+    callback,
+    true,
+    radius_lite::Socket::Transport::IO_URING));
+}
+
+BOOST_AUTO_TEST_CASE(TestOwningConstructor)
+{
+  boost::asio::io_service io_service;
+  BOOST_CHECK_NO_THROW(radius_lite::Socket s(
+    io_service,
+    secret,
+    3002,
+    [](const error_code&, std::optional<radius_lite::Packet>&&, const boost::asio::ip::udp::endpoint&){}));
+}
+
 BOOST_AUTO_TEST_CASE(TestAsyncSend)
 {
   std::array<uint8_t, 16> auth {
@@ -150,7 +195,16 @@ BOOST_AUTO_TEST_CASE(TestAsyncSend)
 
   boost::asio::ip::udp::endpoint destination(boost::asio::ip::address_v4::from_string("127.0.0.1"), 3000);
 
-  radius_lite::Socket s(io_service, "secret", 3000, checkReceive);
+  // receive loop is endless, stop after the first packet
+  radius_lite::Socket s(
+    io_service,
+    secret,
+    3000,
+    [&io_service](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint& source)
+    {
+      io_service.stop();
+      checkReceive(ec, packet, source);
+    });
 
   s.asyncSend(p, destination, checkSend);
 
@@ -160,4 +214,419 @@ BOOST_AUTO_TEST_CASE(TestAsyncSend)
   BOOST_CHECK_MESSAGE(callbackReceiveCalled, "Function asyncReceive hasn't called checkReceive.");
 }
 
+
+BOOST_AUTO_TEST_CASE(TestSocketGroup)
+{
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  const std::vector<radius_lite::Attribute*> attributes {new radius_lite::String(1, "test")};
+  const radius_lite::Packet p(1, 208, auth, attributes, {});
+  const std::vector<uint8_t> buffer = p.makeSendBuffer(secret);
+
+  constexpr size_t clients = 8;
+  constexpr size_t packets_per_client = 16;
+
+  std::atomic<size_t> received{0};
+
+  radius_lite::SocketGroup group(
+    secret,
+    3003,
+    [&received](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint&)
+    {
+      if (!ec && packet && packet->type() == 1)
+      {
+        received.fetch_add(1);
+      }
+    },
+    4);
+
+  BOOST_CHECK_EQUAL(group.size(), 4);
+
+  // every client socket has its own source port, so datagrams are spread over shards
+  boost::asio::io_service io_service;
+  const boost::asio::ip::udp::endpoint destination(boost::asio::ip::address_v4::loopback(), 3003);
+  std::vector<boost::asio::ip::udp::socket> sockets;
+  for (size_t i = 0; i < clients; ++i)
+  {
+    sockets.emplace_back(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+    for (size_t j = 0; j < packets_per_client; ++j)
+    {
+      sockets.back().send_to(boost::asio::buffer(buffer), destination);
+    }
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (received.load() < clients * packets_per_client && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  group.stop();
+
+  BOOST_CHECK_EQUAL(received.load(), clients * packets_per_client);
+
+  uint64_t stats_received = 0;
+  uint64_t stats_errors = 0;
+  for (const auto& stats : group.stats())
+  {
+    stats_received += stats.received;
+    stats_errors += stats.errors;
+  }
+
+  BOOST_CHECK_EQUAL(stats_received, clients * packets_per_client);
+  BOOST_CHECK_EQUAL(stats_errors, 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(TestBatchedReceiveSend)
+{
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  constexpr size_t requests = 20;
+
+  boost::asio::io_service io_service;
+  size_t received = 0;
+  size_t sent = 0;
+
+  // responses are sent from the receive callback
+  radius_lite::Socket* server = nullptr;
+  radius_lite::Socket batched(
+    io_service,
+    secret,
+    3004,
+    [&](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint& source)
+    {
+      BOOST_REQUIRE(!ec);
+      BOOST_REQUIRE(packet);
+      ++received;
+
+      const radius_lite::Packet response(radius_lite::ACCESS_ACCEPT, packet->id(), packet->auth(), {}, {});
+      server->asyncSend(response, source, [&](const error_code& send_ec)
+      {
+        BOOST_CHECK(!send_ec);
+        if (++sent == requests)
+        {
+          io_service.stop();
+        }
+      });
+    });
+  server = &batched;
+  batched.set_batch_size(8);
+
+  // requests are queued by the kernel before the receive loop starts
+  boost::asio::ip::udp::socket client(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  const boost::asio::ip::udp::endpoint destination(boost::asio::ip::address_v4::loopback(), 3004);
+  for (size_t i = 0; i < requests; ++i)
+  {
+    const radius_lite::Packet request(1, static_cast<uint8_t>(i), auth, {new radius_lite::String(1, "test")}, {});
+    client.send_to(boost::asio::buffer(request.makeSendBuffer(secret)), destination);
+  }
+
+  io_service.run_for(std::chrono::seconds(5));
+
+  BOOST_CHECK_EQUAL(received, requests);
+  BOOST_CHECK_EQUAL(sent, requests);
+
+  const auto& stats = batched.io_stats();
+  BOOST_CHECK_EQUAL(stats.received, requests);
+  BOOST_CHECK_EQUAL(stats.sent, requests);
+  BOOST_CHECK_LE(stats.receive_calls, 4);
+  BOOST_CHECK_LE(stats.send_calls, 4);
+
+  std::array<uint8_t, 4096> buffer;
+  for (size_t i = 0; i < requests; ++i)
+  {
+    const size_t bytes = client.receive(boost::asio::buffer(buffer));
+    BOOST_REQUIRE_GE(bytes, 20);
+    BOOST_CHECK_EQUAL(buffer[0], radius_lite::ACCESS_ACCEPT);
+  }
+}
+
+
+BOOST_AUTO_TEST_CASE(TestIoUringTransport)
+{
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  constexpr size_t requests = 20;
+
+  boost::asio::io_service io_service;
+  size_t received = 0;
+  size_t sent = 0;
+
+  radius_lite::Socket* server = nullptr;
+  radius_lite::Socket s(
+    io_service,
+    secret,
+    3005,
+    [&](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint& source)
+    {
+      BOOST_REQUIRE(!ec);
+      BOOST_REQUIRE(packet);
+      ++received;
+
+      const radius_lite::Packet response(radius_lite::ACCESS_ACCEPT, packet->id(), packet->auth(), {}, {});
+      server->asyncSend(response, source, [&](const error_code& send_ec)
+      {
+        BOOST_CHECK(!send_ec);
+        if (++sent == requests)
+        {
+          io_service.stop();
+        }
+      });
+    },
+    false,
+    radius_lite::Socket::Transport::IO_URING);
+  server = &s;
+
+  // kernels without multishot recvmsg fall back to asio, the exchange is the same
+  BOOST_TEST_MESSAGE("io_uring transport: " << (s.transport() == radius_lite::Socket::Transport::IO_URING));
+
+  boost::asio::ip::udp::socket client(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  const boost::asio::ip::udp::endpoint destination(boost::asio::ip::address_v4::loopback(), 3005);
+  for (size_t i = 0; i < requests; ++i)
+  {
+    const radius_lite::Packet request(1, static_cast<uint8_t>(i), auth, {new radius_lite::String(1, "test")}, {});
+    client.send_to(boost::asio::buffer(request.makeSendBuffer(secret)), destination);
+  }
+
+  io_service.run_for(std::chrono::seconds(5));
+
+  BOOST_CHECK_EQUAL(received, requests);
+  BOOST_CHECK_EQUAL(sent, requests);
+  BOOST_CHECK_EQUAL(s.io_stats().received, requests);
+  BOOST_CHECK_EQUAL(s.io_stats().sent, requests);
+  // only submits with sends are send calls, arming the receive isn't
+  BOOST_CHECK_LE(s.io_stats().send_calls, requests);
+
+  std::array<uint8_t, 4096> buffer;
+  for (size_t i = 0; i < requests; ++i)
+  {
+    const size_t bytes = client.receive(boost::asio::buffer(buffer));
+    BOOST_REQUIRE_GE(bytes, 20);
+    BOOST_CHECK_EQUAL(buffer[0], radius_lite::ACCESS_ACCEPT);
+  }
+}
+
+
+BOOST_AUTO_TEST_CASE(TestSendInline)
+{
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  boost::asio::io_service io_service;
+  bool sent_inline = false;
+
+  radius_lite::Socket* server = nullptr;
+  radius_lite::Socket s(
+    io_service,
+    secret,
+    3006,
+    [&](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint& source)
+    {
+      BOOST_REQUIRE(!ec);
+      BOOST_REQUIRE(packet);
+
+      bool called = false;
+      const radius_lite::Packet response(radius_lite::ACCESS_ACCEPT, packet->id(), packet->auth(), {}, {});
+      server->asyncSend(response, source, [&called](const error_code& send_ec)
+      {
+        BOOST_CHECK(!send_ec);
+        called = true;
+      });
+
+      // writable socket: sent by asyncSend itself, nothing is posted
+      sent_inline = called;
+      io_service.stop();
+    });
+  server = &s;
+
+  boost::asio::ip::udp::socket client(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  const radius_lite::Packet request(1, 7, auth, {new radius_lite::String(1, "test")}, {});
+  client.send_to(
+    boost::asio::buffer(request.makeSendBuffer(secret)),
+    boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 3006));
+
+  io_service.run_for(std::chrono::seconds(5));
+
+  BOOST_CHECK(sent_inline);
+  BOOST_CHECK_EQUAL(s.io_stats().sent, 1);
+  BOOST_CHECK_EQUAL(s.io_stats().send_queued, 0);
+
+  std::array<uint8_t, 4096> buffer;
+  BOOST_REQUIRE_GE(client.receive(boost::asio::buffer(buffer)), 20);
+  BOOST_CHECK_EQUAL(buffer[0], radius_lite::ACCESS_ACCEPT);
+  BOOST_CHECK_EQUAL(buffer[1], 7);
+}
+
+BOOST_AUTO_TEST_CASE(TestSendQueueLimit)
+{
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  constexpr size_t requests = 4;
+
+  boost::asio::io_service io_service;
+  size_t completed = 0;
+  std::vector<uint8_t> dropped_ids;
+
+  radius_lite::Socket* server = nullptr;
+  radius_lite::Socket s(
+    io_service,
+    secret,
+    3007,
+    [&](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint& source)
+    {
+      BOOST_REQUIRE(!ec);
+      BOOST_REQUIRE(packet);
+
+      const uint8_t id = packet->id();
+      const radius_lite::Packet response(radius_lite::ACCESS_ACCEPT, id, packet->auth(), {}, {});
+      server->asyncSend(response, source, [&, id](const error_code& send_ec)
+      {
+        if (send_ec == boost::asio::error::no_buffer_space)
+        {
+          dropped_ids.push_back(id);
+        }
+
+        if (++completed == requests)
+        {
+          io_service.stop();
+        }
+      });
+    });
+  server = &s;
+
+  // batched mode queues the responses of one receive batch, the queue holds two of them
+  s.set_batch_size(8);
+  s.set_send_queue_limit(2, radius_lite::Socket::SendDropPolicy::DROP_OLDEST);
+
+  boost::asio::ip::udp::socket client(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  const boost::asio::ip::udp::endpoint destination(boost::asio::ip::address_v4::loopback(), 3007);
+  for (size_t i = 0; i < requests; ++i)
+  {
+    const radius_lite::Packet request(1, static_cast<uint8_t>(i), auth, {new radius_lite::String(1, "test")}, {});
+    client.send_to(boost::asio::buffer(request.makeSendBuffer(secret)), destination);
+  }
+
+  io_service.run_for(std::chrono::seconds(5));
+
+  BOOST_CHECK_EQUAL(completed, requests);
+  BOOST_CHECK_EQUAL(s.io_stats().send_dropped, 2);
+  BOOST_CHECK_EQUAL(s.io_stats().sent, 2);
+  BOOST_REQUIRE_EQUAL(dropped_ids.size(), 2);
+  BOOST_CHECK_EQUAL(dropped_ids[0], 0);
+  BOOST_CHECK_EQUAL(dropped_ids[1], 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestKeepReceivedBuffer)
+{
+  const std::array<uint8_t, 16> auth {
+    0x1a, 0x40, 0x43, 0xc6, 0x41, 0x0a, 0x08, 0x31, 0x12, 0x16, 0x80, 0x2c, 0x3e, 0x83, 0x12, 0x45};
+
+  constexpr size_t requests = 2;
+
+  boost::asio::io_service io_service;
+  std::vector<radius_lite::PacketBufferPtr> kept;
+  size_t echoed = 0;
+
+  radius_lite::Socket* server = nullptr;
+  radius_lite::Socket s(
+    io_service,
+    secret,
+    3008,
+    [&](const error_code& ec, const std::optional<radius_lite::PacketView>& view, const boost::asio::ip::udp::endpoint& source)
+    {
+      BOOST_REQUIRE(!ec);
+      BOOST_REQUIRE(view);
+
+      // the view points into the pooled buffer, it stays valid while the buffer is held
+      radius_lite::PacketBufferPtr buffer = server->received_buffer();
+      BOOST_REQUIRE(buffer);
+      BOOST_CHECK(buffer->data() == view->data());
+      kept.push_back(buffer);
+
+      // the datagram is sent back without copy
+      server->asyncSend(buffer, source, [&](const error_code& send_ec)
+      {
+        BOOST_CHECK(!send_ec);
+        if (++echoed == requests)
+        {
+          io_service.stop();
+        }
+      });
+    });
+  server = &s;
+
+  BOOST_CHECK(!s.received_buffer());
+
+  boost::asio::ip::udp::socket client(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  std::vector<std::vector<uint8_t>> datagrams;
+  for (uint8_t id = 0; id < requests; ++id)
+  {
+    const radius_lite::Packet request(1, id, auth, {new radius_lite::String(1, "test")}, {});
+    datagrams.push_back(request.makeSendBuffer(secret));
+    client.send_to(
+      boost::asio::buffer(datagrams.back()),
+      boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 3008));
+  }
+
+  io_service.run_for(std::chrono::seconds(5));
+
+  // the kept buffer isn't reused by the next receive
+  BOOST_REQUIRE_EQUAL(kept.size(), requests);
+  BOOST_CHECK(kept[0] != kept[1]);
+
+  for (size_t i = 0; i < requests; ++i)
+  {
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+      kept[i]->data(), kept[i]->data() + kept[i]->size(),
+      datagrams[i].begin(), datagrams[i].end());
+
+    std::array<uint8_t, 4096> buffer;
+    const size_t size = client.receive(boost::asio::buffer(buffer));
+    BOOST_CHECK_EQUAL_COLLECTIONS(buffer.begin(), buffer.begin() + size, datagrams[i].begin(), datagrams[i].end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMalformedDatagram)
+{
+  boost::asio::io_service io_service;
+  size_t errors = 0;
+
+  radius_lite::Socket s(
+    io_service,
+    secret,
+    3009,
+    [&](const error_code& ec, std::optional<radius_lite::Packet>&& packet, const boost::asio::ip::udp::endpoint&)
+    {
+      BOOST_CHECK(ec);
+      BOOST_CHECK(!packet);
+
+      if (++errors == 2)
+      {
+        io_service.stop();
+      }
+    });
+
+  boost::asio::ip::udp::socket client(io_service, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  const boost::asio::ip::udp::endpoint destination(boost::asio::ip::address_v4::loopback(), 3009);
+
+  // shorter than a header, and a header with a length beyond the datagram
+  const std::vector<uint8_t> short_datagram {0x01, 0x02, 0x00};
+  std::vector<uint8_t> long_length(20, 0);
+  long_length[0] = 0x01;
+  long_length[3] = 0xff;
+  client.send_to(boost::asio::buffer(short_datagram), destination);
+  client.send_to(boost::asio::buffer(long_length), destination);
+
+  io_service.run_for(std::chrono::seconds(5));
+
+  BOOST_CHECK_EQUAL(errors, 2);
+  BOOST_CHECK_EQUAL(s.io_stats().received, 2);
+  BOOST_CHECK_EQUAL(s.io_stats().parse_errors, 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
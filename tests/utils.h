@@ -5,5 +5,5 @@
 #include "vendor_attribute.h"
 
 radius_lite::Attribute*
-findAttribute(const std::vector<radius_lite::Attribute*>& attributes, radius_lite::Attribute_Types type);
+findAttribute(const std::vector<radius_lite::AttributeHolder>& attributes, radius_lite::Attribute_Types type);
 
@@ -0,0 +1,29 @@
+#include <iostream>
+#include <string>
+
+#include "dictionaries.h"
+#include "frozen_dictionaries.h"
+
+// compiles text dictionaries into the image mapped by FrozenDictionaries::load/open
+int main(int argc, char* argv[])
+{
+  if (argc != 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " <dictionary> <image>" << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    radius_lite::Dictionaries dictionaries(argv[1]);
+    dictionaries.resolve();
+    radius_lite::FrozenDictionaries(dictionaries).save(argv[2]);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}